@@ -0,0 +1,129 @@
+// Decode throughput of FileDecoder's memory-mapped WAV path against the
+// miniaudio path for float and 16-bit PCM files, checking that both yield the
+// same mono samples (mapped mono float is handed out in place, so it may keep
+// a -0.0 that the miniaudio path turns into +0.0).
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "file_decoder.h"
+
+namespace {
+
+constexpr std::uint32_t kSampleRate = 48000;
+constexpr std::size_t kSeconds = 120;
+constexpr int kRuns = 3;
+
+void put_u16(std::ofstream& out, std::uint16_t value) {
+    const char bytes[2] = {static_cast<char>(value & 0xff), static_cast<char>(value >> 8)};
+    out.write(bytes, 2);
+}
+
+void put_u32(std::ofstream& out, std::uint32_t value) {
+    put_u16(out, static_cast<std::uint16_t>(value & 0xffff));
+    put_u16(out, static_cast<std::uint16_t>(value >> 16));
+}
+
+// Plain (non-extensible) WAV of noise in the given format.
+void write_wav(const std::string& path, std::uint16_t channels, std::uint32_t rate, bool f32) {
+    const std::size_t frames = static_cast<std::size_t>(rate) * kSeconds;
+    const std::uint16_t sample_bytes = f32 ? 4 : 2;
+    const std::uint32_t data_bytes = static_cast<std::uint32_t>(frames * channels * sample_bytes);
+    std::ofstream out(path, std::ios::binary);
+    out.write("RIFF", 4);
+    put_u32(out, 36 + data_bytes);
+    out.write("WAVEfmt ", 8);
+    put_u32(out, 16);
+    put_u16(out, f32 ? 3 : 1);
+    put_u16(out, channels);
+    put_u32(out, rate);
+    put_u32(out, rate * channels * sample_bytes);
+    put_u16(out, static_cast<std::uint16_t>(channels * sample_bytes));
+    put_u16(out, static_cast<std::uint16_t>(sample_bytes * 8));
+    out.write("data", 4);
+    put_u32(out, data_bytes);
+
+    std::mt19937 rng(channels * 31 + rate);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (std::size_t i = 0; i < frames * channels; ++i) {
+        const float value = dist(rng);
+        if (f32) {
+            out.write(reinterpret_cast<const char*>(&value), 4);
+        } else {
+            const std::int16_t pcm = static_cast<std::int16_t>(value * 32767.0f);
+            out.write(reinterpret_cast<const char*>(&pcm), 2);
+        }
+    }
+}
+
+struct Result {
+    double ns_per_frame = 0.0;
+    std::vector<float> samples;
+};
+
+Result decode(const std::string& path, bool mapped) {
+    Result result;
+    result.ns_per_frame = 1e300;
+    for (int run = 0; run < kRuns; ++run) {
+        std::vector<float> samples;
+        samples.reserve(kSampleRate * kSeconds + 1024);
+        const auto start = std::chrono::steady_clock::now();
+        who::FileDecoder decoder(path, kSampleRate, mapped);
+        const float* block = nullptr;
+        while (const std::size_t frames = decoder.read(block)) {
+            samples.insert(samples.end(), block, block + frames);
+        }
+        const double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        result.ns_per_frame = std::min(result.ns_per_frame, elapsed / static_cast<double>(samples.size()));
+        result.samples = std::move(samples);
+    }
+    return result;
+}
+
+} // namespace
+
+int main() {
+    struct Case {
+        const char* name;
+        std::uint16_t channels;
+        std::uint32_t rate;
+        bool f32;
+    };
+    const Case cases[] = {
+        {"f32 mono 48k", 1, 48000, true},
+        {"f32 stereo 48k", 2, 48000, true},
+        {"s16 stereo 48k", 2, 48000, false},
+        {"s16 stereo 44.1k", 2, 44100, false},
+    };
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    bool all_ok = true;
+    std::printf("%zu s per file, best of %d, output %u Hz mono\n", kSeconds, kRuns, kSampleRate);
+    std::printf("%-18s %16s %16s %8s %6s\n", "file", "decoder ns/frame", "mapped ns/frame", "speedup", "exact");
+    for (const Case& test : cases) {
+        const std::string path = (dir / ("who_bench_decode_" + std::to_string(test.channels) + "_" +
+                                         std::to_string(test.rate) + (test.f32 ? "_f32" : "_s16") + ".wav"))
+                                     .string();
+        write_wav(path, test.channels, test.rate, test.f32);
+        if (!who::FileDecoder(path, kSampleRate).mapped()) {
+            std::fprintf(stderr, "[%s] mapped path not taken\n", test.name);
+            all_ok = false;
+        }
+        const Result reference = decode(path, false);
+        const Result mapped = decode(path, true);
+        // Compared as values so -0.0 == +0.0.
+        const bool exact = reference.samples == mapped.samples;
+        all_ok = all_ok && exact;
+        std::printf("%-18s %16.3f %16.3f %7.2fx %6s\n", test.name, reference.ns_per_frame, mapped.ns_per_frame,
+                    reference.ns_per_frame / mapped.ns_per_frame, exact ? "yes" : "NO");
+        std::filesystem::remove(path);
+    }
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+// Per-transform cost of the compile-time specialised complex FFTs against
+// kiss_fft at each supported size, with an accuracy check against kiss_fft.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "fft.h"
+
+namespace {
+
+template <typename Fn>
+double time_ns(std::size_t iterations, Fn&& fn) {
+    fn();
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(iterations);
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    bool all_ok = true;
+    std::printf("%6s %14s %14s %8s %12s\n", "size", "kiss ns/fft", "fixed ns/fft", "speedup", "max rel err");
+    for (std::size_t size : {256u, 512u, 1024u, 2048u, 4096u}) {
+        std::vector<kiss_fft_cpx> input(size);
+        for (kiss_fft_cpx& value : input) {
+            value.r = dist(rng);
+            value.i = dist(rng);
+        }
+        std::vector<kiss_fft_cpx> kiss_out(size);
+        std::vector<kiss_fft_cpx> fixed_out(size);
+
+        kiss_fft_cfg cfg = kiss_fft_alloc(static_cast<int>(size), 0, nullptr, nullptr);
+        const who::ComplexFftKernel kernel = who::fixed_complex_fft(size);
+        if (!cfg || !kernel) {
+            std::fprintf(stderr, "missing transform for size %zu\n", size);
+            return 1;
+        }
+
+        kiss_fft(cfg, input.data(), kiss_out.data());
+        kernel(input.data(), fixed_out.data());
+        double max_error = 0.0;
+        double max_magnitude = 0.0;
+        for (std::size_t k = 0; k < size; ++k) {
+            max_error = std::max(max_error, static_cast<double>(std::hypot(kiss_out[k].r - fixed_out[k].r,
+                                                                           kiss_out[k].i - fixed_out[k].i)));
+            max_magnitude = std::max(max_magnitude, static_cast<double>(std::hypot(kiss_out[k].r, kiss_out[k].i)));
+        }
+        const double relative_error = max_magnitude > 0.0 ? max_error / max_magnitude : max_error;
+        const bool ok = relative_error < 1e-5;
+        all_ok = all_ok && ok;
+
+        const std::size_t iterations = std::max<std::size_t>(1000, (1u << 24) / size);
+        const double kiss_ns = time_ns(iterations, [&] { kiss_fft(cfg, input.data(), kiss_out.data()); });
+        const double fixed_ns = time_ns(iterations, [&] { kernel(input.data(), fixed_out.data()); });
+        std::printf("%6zu %14.1f %14.1f %7.2fx %12.2e%s\n", size, kiss_ns, fixed_ns, kiss_ns / fixed_ns, relative_error,
+                    ok ? "" : "  MISMATCH");
+        kiss_fft_free(cfg);
+    }
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+// Verifies every vectorized kernel table is bit-identical to the scalar
+// reference, then times float and 16-bit downmix, windowing, spectrum power and
+// pixel fill per table.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "simd_kernels.h"
+
+namespace {
+
+using who::kernels::KernelTable;
+
+std::vector<float> make_signal(std::size_t count, std::uint32_t seed, bool with_specials = true) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> values(count);
+    for (float& v : values) {
+        v = dist(rng);
+    }
+    if (!with_specials) {
+        return values;
+    }
+    // Sprinkle in the values most likely to expose ordering differences.
+    const float specials[] = {0.0f, -0.0f, std::numeric_limits<float>::denorm_min(), -1.0e-40f, 1.0e30f, -1.0e30f,
+                              std::numeric_limits<float>::min(), 3.0f, -7.5e-8f};
+    for (std::size_t i = 0; i < count; i += 37) {
+        values[i] = specials[(i / 37) % (sizeof(specials) / sizeof(specials[0]))];
+    }
+    return values;
+}
+
+std::vector<std::int16_t> make_pcm16(std::size_t count, std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    std::vector<std::int16_t> values(count);
+    for (std::int16_t& v : values) {
+        v = static_cast<std::int16_t>(dist(rng));
+    }
+    // Full-scale runs exercise the widest channel sums.
+    for (std::size_t i = 0; i < count; i += 29) {
+        values[i] = (i / 29) % 2 == 0 ? std::int16_t{-32768} : std::int16_t{32767};
+    }
+    return values;
+}
+
+bool same_bits(const std::vector<float>& a, const std::vector<float>& b, std::size_t count) {
+    return std::memcmp(a.data(), b.data(), count * sizeof(float)) == 0;
+}
+
+bool verify(const KernelTable& table) {
+    const KernelTable& ref = who::kernels::scalar_kernels();
+    bool ok = true;
+    for (std::size_t count : {0u, 1u, 3u, 7u, 8u, 15u, 16u, 17u, 257u, 1024u, 2049u}) {
+        for (std::size_t channels : {1u, 2u, 3u, 6u}) {
+            const std::vector<float> input = make_signal(count * channels, static_cast<std::uint32_t>(count + channels));
+            std::vector<float> expected(count + 1, 0.0f);
+            std::vector<float> actual(count + 1, 0.0f);
+            ref.downmix(input.data(), count, channels, expected.data());
+            table.downmix(input.data(), count, channels, actual.data());
+            if (!same_bits(expected, actual, count)) {
+                std::fprintf(stderr, "[%s] downmix mismatch (frames=%zu, channels=%zu)\n", table.name, count, channels);
+                ok = false;
+            }
+
+            const std::vector<std::int16_t> pcm =
+                make_pcm16(count * channels, static_cast<std::uint32_t>(count * 7 + channels));
+            ref.downmix_s16(pcm.data(), count, channels, expected.data());
+            table.downmix_s16(pcm.data(), count, channels, actual.data());
+            if (!same_bits(expected, actual, count)) {
+                std::fprintf(stderr, "[%s] downmix_s16 mismatch (frames=%zu, channels=%zu)\n", table.name, count,
+                             channels);
+                ok = false;
+            }
+        }
+
+        const std::vector<float> input = make_signal(count, 11);
+        const std::vector<float> window = make_signal(count, 12);
+        std::vector<float> expected(count + 1, 0.0f);
+        std::vector<float> actual(count + 1, 0.0f);
+        ref.apply_window(input.data(), window.data(), expected.data(), count);
+        table.apply_window(input.data(), window.data(), actual.data(), count);
+        if (!same_bits(expected, actual, count)) {
+            std::fprintf(stderr, "[%s] apply_window mismatch (count=%zu)\n", table.name, count);
+            ok = false;
+        }
+
+        const std::vector<float> spectrum = make_signal(count * 2, 13);
+        const float norm = 1.0f / 1024.0f;
+        ref.spectrum_power(spectrum.data(), norm, expected.data(), count);
+        table.spectrum_power(spectrum.data(), norm, actual.data(), count);
+        if (!same_bits(expected, actual, count)) {
+            std::fprintf(stderr, "[%s] spectrum_power mismatch (bins=%zu)\n", table.name, count);
+            ok = false;
+        }
+
+        // One guard element past the end catches overruns.
+        std::vector<std::uint32_t> pixels(count + 1, 0u);
+        table.fill_u32(pixels.data(), 0xff336699u, count);
+        if (std::count(pixels.begin(), pixels.end() - 1, 0xff336699u) != static_cast<std::ptrdiff_t>(count) ||
+            pixels.back() != 0u) {
+            std::fprintf(stderr, "[%s] fill_u32 mismatch (count=%zu)\n", table.name, count);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+template <typename Fn>
+double time_ns(std::size_t iterations, std::size_t elements, Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           static_cast<double>(iterations * elements);
+}
+
+} // namespace
+
+int main() {
+    constexpr std::size_t kFrames = 4096;
+    constexpr std::size_t kIterations = 20000;
+
+    // Timing inputs avoid denormals so the numbers reflect the common case.
+    const std::vector<float> stereo = make_signal(kFrames * 2, 1, false);
+    const std::vector<std::int16_t> stereo_pcm = make_pcm16(kFrames * 2, 4);
+    const std::vector<float> window = make_signal(kFrames, 2, false);
+    const std::vector<float> spectrum = make_signal((kFrames / 2 + 1) * 2, 3, false);
+    std::vector<float> output(kFrames);
+    std::vector<std::uint32_t> pixels(kFrames);
+
+    bool all_ok = true;
+    std::printf("active table: %s\n", who::kernels::active_kernels().name);
+    std::printf("%-8s %8s %18s %18s %18s %18s %18s\n", "table", "exact", "downmix ns/frame", "s16 ns/frame",
+                "window ns/sample", "power ns/bin", "fill ns/pixel");
+    for (const KernelTable* table : who::kernels::available_kernels()) {
+        const bool ok = verify(*table);
+        all_ok = all_ok && ok;
+        const double downmix_ns = time_ns(kIterations, kFrames, [&] {
+            table->downmix(stereo.data(), kFrames, 2, output.data());
+        });
+        const double s16_ns = time_ns(kIterations, kFrames, [&] {
+            table->downmix_s16(stereo_pcm.data(), kFrames, 2, output.data());
+        });
+        const double window_ns = time_ns(kIterations, kFrames, [&] {
+            table->apply_window(stereo.data(), window.data(), output.data(), kFrames);
+        });
+        const double power_ns = time_ns(kIterations, kFrames / 2 + 1, [&] {
+            table->spectrum_power(spectrum.data(), 1.0f / kFrames, output.data(), kFrames / 2 + 1);
+        });
+        const double fill_ns = time_ns(kIterations, kFrames, [&] {
+            table->fill_u32(pixels.data(), 0xff336699u, kFrames);
+        });
+        std::printf("%-8s %8s %18.3f %18.3f %18.3f %18.3f %18.3f\n", table->name, ok ? "yes" : "NO", downmix_ns,
+                    s16_ns, window_ns, power_ns, fill_ns);
+    }
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,214 @@
+// Headless Renderer cost for every mode x palette at several grid sizes,
+// rendering synthetic bands into a MemoryBackend, followed by a bytes/frame
+// comparison of the sub-cell blitters against solid fill and the pixel
+// blitter's rasterisation cost on a 1920x1080 surface.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "memory_backend.h"
+#include "renderer.h"
+
+namespace {
+
+constexpr unsigned int kTermRows = 60;
+constexpr unsigned int kTermCols = 200;
+constexpr int kFrames = 600;
+constexpr float kFrameSeconds = 1.0f / 60.0f;
+// 1920x1080 pixels as 192x54 cells of 10x20 pixels.
+constexpr unsigned int kPixelRows = 54;
+constexpr unsigned int kPixelCols = 192;
+constexpr who::CellPixels kCellPixels{10, 20};
+
+void synth_bands(std::vector<float>& bands, float time_s) {
+    for (std::size_t i = 0; i < bands.size(); ++i) {
+        const float phase = time_s * (1.5f + 0.21f * static_cast<float>(i));
+        bands[i] = 0.02f + 0.5f * (0.5f + 0.5f * std::sin(phase)) / (1.0f + 0.15f * static_cast<float>(i));
+    }
+}
+
+float synth_beat(float time_s) {
+    const float beat_phase = std::fmod(time_s * 2.0f, 1.0f);
+    return beat_phase < 0.1f ? 1.0f - beat_phase * 10.0f : 0.0f;
+}
+
+// Terminal cells currently showing grid output (overlay disabled).
+std::size_t footprint(const who::MemoryBackend& backend) {
+    std::size_t covered = 0;
+    for (unsigned int y = 0; y < backend.rows(); ++y) {
+        for (unsigned int x = 0; x < backend.cols(); ++x) {
+            const who::MemoryBackend::Cell& cell = backend.at(static_cast<int>(y), static_cast<int>(x));
+            if (cell.glyph != U' ' || !cell.default_background) {
+                ++covered;
+            }
+        }
+    }
+    return covered;
+}
+
+int pixels_per_cell(who::GridBlitter blitter) {
+    switch (blitter) {
+    case who::GridBlitter::HalfBlock:
+        return 2;
+    case who::GridBlitter::Quadrant:
+        return 4;
+    case who::GridBlitter::Sextant:
+        return 6;
+    case who::GridBlitter::Braille:
+        return 8;
+    case who::GridBlitter::Solid:
+    case who::GridBlitter::Pixel:
+        break;
+    }
+    return 1;
+}
+
+} // namespace
+
+int main() {
+    const who::VisualizationMode modes[] = {who::VisualizationMode::Bands,
+                                            who::VisualizationMode::Radial,
+                                            who::VisualizationMode::Trails,
+                                            who::VisualizationMode::Digital,
+                                            who::VisualizationMode::Ascii};
+    const who::ColorPalette palettes[] = {who::ColorPalette::Rainbow,
+                                          who::ColorPalette::WarmCool,
+                                          who::ColorPalette::DigitalAmber,
+                                          who::ColorPalette::DigitalCyan,
+                                          who::ColorPalette::DigitalViolet};
+    const int grids[] = {8, 16, 24, 32};
+
+    const who::GridBlitter blitters[] = {who::GridBlitter::Solid,
+                                         who::GridBlitter::HalfBlock,
+                                         who::GridBlitter::Quadrant,
+                                         who::GridBlitter::Sextant,
+                                         who::GridBlitter::Braille};
+
+    who::MemoryBackend backend(kTermRows, kTermCols);
+    who::Renderer renderer(backend);
+    who::MemoryBackend hd_backend(kPixelRows, kPixelCols, kCellPixels);
+    who::Renderer hd_renderer(hd_backend);
+    std::vector<float> bands(32, 0.0f);
+    who::AudioMetrics metrics;
+    metrics.active = true;
+    const who::FrameStats frame_stats{};
+
+    struct Result {
+        double ns;
+        double cells;
+        double calls;
+        double writes;
+        double bytes;
+    };
+    auto run_on = [&](who::Renderer& target, who::MemoryBackend& surface, who::VisualizationMode mode,
+                      who::ColorPalette palette, who::GridBlitter blitter, int grid, bool overlay) {
+        who::ViewSettings view;
+        view.grid_rows = grid;
+        view.grid_cols = grid;
+        view.mode = mode;
+        view.palette = palette;
+        view.blitter = blitter;
+        float time_s = 0.0f;
+        auto frame = [&] {
+            synth_bands(bands, time_s);
+            target.draw(view, who::FrameInput{time_s, metrics, bands, synth_beat(time_s), false, frame_stats}, overlay);
+            time_s += kFrameSeconds;
+        };
+
+        // The first frame after a geometry or mode change repaints
+        // everything; keep it out of the steady-state numbers.
+        frame();
+        surface.reset_counters();
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kFrames; ++i) {
+            frame();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        const who::MemoryBackend::Counters& counters = surface.counters();
+        return Result{std::chrono::duration<double, std::nano>(end - start).count() / kFrames,
+                      static_cast<double>(counters.cells) / kFrames,
+                      static_cast<double>(counters.calls) / kFrames,
+                      static_cast<double>(counters.writes) / kFrames,
+                      static_cast<double>(counters.bytes) / kFrames};
+    };
+    auto run = [&](who::VisualizationMode mode, who::ColorPalette palette, who::GridBlitter blitter, int grid,
+                   bool overlay) { return run_on(renderer, backend, mode, palette, blitter, grid, overlay); };
+
+    std::printf("%-14s %-15s %5s %12s %12s %12s %12s %12s\n", "mode", "palette", "grid", "ns/frame", "cells/frame",
+                "calls/frame", "writes/frame", "bytes/frame");
+    for (who::VisualizationMode mode : modes) {
+        for (who::ColorPalette palette : palettes) {
+            for (int grid : grids) {
+                const Result result = run(mode, palette, who::GridBlitter::Solid, grid, true);
+                std::printf("%-14s %-15s %2dx%-2d %12.0f %12.1f %12.1f %12.1f %12.1f\n",
+                            who::mode_name(mode),
+                            who::palette_name(palette),
+                            grid,
+                            grid,
+                            result.ns,
+                            result.cells,
+                            result.calls,
+                            result.writes,
+                            result.bytes);
+            }
+        }
+    }
+
+    // Sub-cell blitters draw the same grid larger and with finer gutters, so
+    // compare cost per terminal cell and per logical pixel of grid area too.
+    std::printf("\n%-14s %-15s %-11s %11s %12s %10s %11s %9s %9s\n", "mode", "palette", "blitter", "ns/frame",
+                "bytes/frame", "vs solid", "term cells", "B/cell", "B/100px");
+    for (who::VisualizationMode mode : modes) {
+        if (mode == who::VisualizationMode::Ascii) {
+            continue; // always glyph-based
+        }
+        for (who::ColorPalette palette : {who::ColorPalette::Rainbow, who::ColorPalette::DigitalAmber}) {
+            double solid_bytes = 0.0;
+            for (who::GridBlitter blitter : blitters) {
+                const Result result = run(mode, palette, blitter, 32, false);
+                if (blitter == who::GridBlitter::Solid) {
+                    solid_bytes = result.bytes;
+                }
+                const double covered = static_cast<double>(std::max<std::size_t>(1, footprint(backend)));
+                std::printf("%-14s %-15s %-11s %11.0f %12.1f %9.2fx %11.0f %9.2f %9.2f\n",
+                            who::mode_name(mode),
+                            who::palette_name(palette),
+                            who::blitter_name(blitter),
+                            result.ns,
+                            result.bytes,
+                            solid_bytes > 0.0 ? result.bytes / solid_bytes : 0.0,
+                            covered,
+                            result.bytes / covered,
+                            100.0 * result.bytes / (covered * pixels_per_cell(blitter)));
+            }
+        }
+    }
+
+    // The pixel blitter rasterises the whole grid area at display resolution;
+    // solid fill on the same surface is the cell-output baseline.
+    std::printf("\n%-14s %5s %13s %13s %10s %13s %13s\n", "mode", "grid", "pixel ns/fr", "solid ns/fr", "Mpx/frame",
+                "pixel B/fr", "solid B/fr");
+    for (who::VisualizationMode mode : modes) {
+        if (mode == who::VisualizationMode::Ascii) {
+            continue;
+        }
+        for (int grid : {16, 32, 64}) {
+            const Result solid = run_on(hd_renderer, hd_backend, mode, who::ColorPalette::Rainbow,
+                                        who::GridBlitter::Solid, grid, false);
+            const Result pixel = run_on(hd_renderer, hd_backend, mode, who::ColorPalette::Rainbow,
+                                        who::GridBlitter::Pixel, grid, false);
+            std::printf("%-14s %2dx%-2d %13.0f %13.0f %10.2f %13.0f %13.0f\n",
+                        who::mode_name(mode),
+                        grid,
+                        grid,
+                        pixel.ns,
+                        solid.ns,
+                        static_cast<double>(hd_backend.image_pixels().size()) / 1.0e6,
+                        pixel.bytes,
+                        solid.bytes);
+        }
+    }
+    return 0;
+}
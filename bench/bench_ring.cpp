@@ -0,0 +1,192 @@
+// Producer/consumer throughput of the legacy audio ring (adjacent indices,
+// modulo wrapping, copy-out reads) against SpscRing with copying reads and
+// with in-place reserve_read()/commit_read(), with the two threads pinned to
+// separate cores where the platform allows it.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "spsc_ring.h"
+
+namespace {
+
+constexpr std::size_t kCapacity = 16384;
+constexpr std::size_t kChunk = 480;  // 10 ms of mono at 48 kHz per callback
+constexpr std::size_t kBatch = 4096; // DSP worker read size
+constexpr std::size_t kTotalSamples = 48000 * 60 * 20;
+constexpr int kRuns = 3;
+
+class LegacyRing {
+public:
+    explicit LegacyRing(std::size_t capacity) : buffer_(capacity), capacity_(capacity), head_(0), tail_(0) {}
+
+    std::size_t write(const float* data, std::size_t count) {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        const std::size_t tail = tail_.load(std::memory_order_acquire);
+        const std::size_t used = head - tail;
+        const std::size_t free_space = capacity_ > used ? capacity_ - used : 0;
+        const std::size_t to_write = std::min(count, free_space);
+        if (to_write == 0) {
+            return 0;
+        }
+        const std::size_t first_chunk = std::min(to_write, capacity_ - (head % capacity_));
+        std::memcpy(&buffer_[head % capacity_], data, first_chunk * sizeof(float));
+        if (to_write > first_chunk) {
+            std::memcpy(buffer_.data(), data + first_chunk, (to_write - first_chunk) * sizeof(float));
+        }
+        head_.store(head + to_write, std::memory_order_release);
+        return to_write;
+    }
+
+    std::size_t read(float* dest, std::size_t count) {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        const std::size_t head = head_.load(std::memory_order_acquire);
+        const std::size_t to_read = std::min(count, head - tail);
+        if (to_read == 0) {
+            return 0;
+        }
+        const std::size_t first_chunk = std::min(to_read, capacity_ - (tail % capacity_));
+        std::memcpy(dest, &buffer_[tail % capacity_], first_chunk * sizeof(float));
+        if (to_read > first_chunk) {
+            std::memcpy(dest + first_chunk, buffer_.data(), (to_read - first_chunk) * sizeof(float));
+        }
+        tail_.store(tail + to_read, std::memory_order_release);
+        return to_read;
+    }
+
+private:
+    std::vector<float> buffer_;
+    const std::size_t capacity_;
+    std::atomic<std::size_t> head_;
+    std::atomic<std::size_t> tail_;
+};
+
+void pin_to_core(unsigned int core) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % std::max(1u, std::thread::hardware_concurrency()), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)core;
+#endif
+}
+
+float sample_value(std::size_t index) {
+    return static_cast<float>(index & 0xFFFFF);
+}
+
+// Tracks the next expected sample so a reordered or lost sample fails the run.
+struct Checker {
+    std::size_t next = 0;
+    bool ok = true;
+
+    void consume(const float* data, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            ok = ok && data[i] == sample_value(next + i);
+        }
+        next += count;
+    }
+};
+
+template <typename Write>
+void run_producer(Write&& write) {
+    pin_to_core(0);
+    std::vector<float> chunk(kChunk);
+    std::size_t sent = 0;
+    while (sent < kTotalSamples) {
+        const std::size_t count = std::min(kChunk, kTotalSamples - sent);
+        for (std::size_t i = 0; i < count; ++i) {
+            chunk[i] = sample_value(sent + i);
+        }
+        std::size_t done = 0;
+        while (done < count) {
+            const std::size_t written = write(chunk.data() + done, count - done);
+            if (written == 0) {
+                std::this_thread::yield();
+            }
+            done += written;
+        }
+        sent += count;
+    }
+}
+
+struct Result {
+    double ns_per_sample;
+    bool exact;
+};
+
+template <typename Ring, typename Consume>
+Result measure(Consume&& consume) {
+    double best = 1e30;
+    bool exact = true;
+    for (int run = 0; run < kRuns; ++run) {
+        Ring ring(kCapacity);
+        Checker checker;
+        const auto start = std::chrono::steady_clock::now();
+        std::thread producer([&] { run_producer([&](const float* data, std::size_t count) { return ring.write(data, count); }); });
+        pin_to_core(1);
+        while (checker.next < kTotalSamples) {
+            if (consume(ring, checker) == 0) {
+                std::this_thread::yield();
+            }
+        }
+        producer.join();
+        const double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, elapsed / static_cast<double>(kTotalSamples));
+        exact = exact && checker.ok;
+    }
+    return Result{best, exact};
+}
+
+} // namespace
+
+int main() {
+    std::vector<float> scratch(kBatch);
+    const Result legacy = measure<LegacyRing>([&](LegacyRing& ring, Checker& checker) {
+        const std::size_t count = ring.read(scratch.data(), kBatch);
+        checker.consume(scratch.data(), count);
+        return count;
+    });
+    const Result copy = measure<who::SpscRing<float>>([&](who::SpscRing<float>& ring, Checker& checker) {
+        const std::size_t count = ring.read(scratch.data(), kBatch);
+        checker.consume(scratch.data(), count);
+        return count;
+    });
+    const Result in_place = measure<who::SpscRing<float>>([&](who::SpscRing<float>& ring, Checker& checker) {
+        const who::RingSpan<float> span = ring.reserve_read(kBatch);
+        checker.consume(span.first, span.first_size);
+        checker.consume(span.second, span.second_size);
+        ring.commit_read(span.size());
+        return span.size();
+    });
+
+    std::printf("%zu samples, %zu-sample writes, %zu-sample reads, capacity %zu, best of %d\n",
+                kTotalSamples,
+                kChunk,
+                kBatch,
+                kCapacity,
+                kRuns);
+    std::printf("%-26s %10s %12s %8s %6s\n", "ring", "ns/sample", "Msamples/s", "speedup", "exact");
+    const auto row = [&](const char* name, const Result& result) {
+        std::printf("%-26s %10.3f %12.1f %7.2fx %6s\n",
+                    name,
+                    result.ns_per_sample,
+                    1e3 / result.ns_per_sample,
+                    legacy.ns_per_sample / result.ns_per_sample,
+                    result.exact ? "yes" : "NO");
+    };
+    row("legacy (modulo, shared)", legacy);
+    row("SpscRing read()", copy);
+    row("SpscRing reserve/commit", in_place);
+    return legacy.exact && copy.exact && in_place.exact ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+// Compares the legacy deque FIFO + per-hop memmove frame assembly against the
+// mirrored SlidingWindow used by DspEngine.
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "sliding_window.h"
+
+namespace {
+
+constexpr std::size_t kFftSize = 4096;
+constexpr std::size_t kChunk = 480; // 10 ms at 48 kHz
+constexpr std::size_t kTotalSamples = 48000 * 60;
+
+class DequeFrames {
+public:
+    explicit DequeFrames(std::size_t hop) : hop_(hop), frame_(kFftSize, 0.0f) {}
+
+    template <typename Consume>
+    void push(const float* samples, std::size_t count, Consume&& consume) {
+        for (std::size_t i = 0; i < count; ++i) {
+            fifo_.push_back(samples[i]);
+        }
+        while (fifo_.size() >= hop_) {
+            std::memmove(frame_.data(), frame_.data() + hop_, (kFftSize - hop_) * sizeof(float));
+            for (std::size_t i = 0; i < hop_; ++i) {
+                frame_[kFftSize - hop_ + i] = fifo_.front();
+                fifo_.pop_front();
+            }
+            consume(frame_.data());
+        }
+    }
+
+private:
+    std::size_t hop_;
+    std::vector<float> frame_;
+    std::deque<float> fifo_;
+};
+
+class MirroredFrames {
+public:
+    explicit MirroredFrames(std::size_t hop) : hop_(hop), history_(kFftSize), fill_(0) {}
+
+    template <typename Consume>
+    void push(const float* samples, std::size_t count, Consume&& consume) {
+        for (std::size_t i = 0; i < count; ++i) {
+            history_.push(samples[i]);
+            if (++fill_ == hop_) {
+                fill_ = 0;
+                consume(history_.view());
+            }
+        }
+    }
+
+private:
+    std::size_t hop_;
+    who::SlidingWindow history_;
+    std::size_t fill_;
+};
+
+template <typename Frames>
+double run(std::size_t hop, const std::vector<float>& input, bool touch_frame, float& checksum) {
+    Frames frames(hop);
+    // Optionally touch every frame sample once, as the window multiply in
+    // process_frame does; otherwise measure frame assembly alone.
+    auto consume = [&](const float* frame) {
+        if (!touch_frame) {
+            checksum += frame[0] + frame[kFftSize - 1];
+            return;
+        }
+        float acc = 0.0f;
+        for (std::size_t i = 0; i < kFftSize; ++i) {
+            acc += frame[i];
+        }
+        checksum += acc;
+    };
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t offset = 0; offset + kChunk <= input.size(); offset += kChunk) {
+        frames.push(input.data() + offset, kChunk, consume);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(input.size());
+}
+
+} // namespace
+
+int main() {
+    std::vector<float> input(kTotalSamples);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (float& sample : input) {
+        sample = dist(rng);
+    }
+
+    std::printf("fft_size=%zu, %zu samples in %zu-sample chunks\n", kFftSize, input.size(), kChunk);
+    for (bool touch_frame : {false, true}) {
+        std::printf("\n%s\n", touch_frame ? "assembly + full frame read" : "frame assembly only");
+        std::printf("%8s %16s %16s %8s\n", "hop", "deque ns/sample", "mirror ns/sample", "speedup");
+        for (std::size_t hop : {256u, 512u, 1024u, 4096u}) {
+            float deque_sum = 0.0f;
+            float mirror_sum = 0.0f;
+            const double deque_ns = run<DequeFrames>(hop, input, touch_frame, deque_sum);
+            const double mirror_ns = run<MirroredFrames>(hop, input, touch_frame, mirror_sum);
+            if (deque_sum != mirror_sum) {
+                std::fprintf(stderr, "frame mismatch at hop %zu\n", hop);
+                return 1;
+            }
+            std::printf("%8zu %16.3f %16.3f %7.2fx\n", hop, deque_ns, mirror_ns, deque_ns / mirror_ns);
+        }
+    }
+    return 0;
+}
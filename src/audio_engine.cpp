@@ -6,9 +6,9 @@
 
 #include <algorithm>
 #include <chrono>
-#include <cmath>
 #include <cctype>
 #include <cstring>
+#include <exception>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -44,66 +44,29 @@ bool contains_ignore_case(std::string_view haystack, std::string_view needle) {
     return lower_haystack.find(lower_needle) != std::string::npos;
 }
 
-} // namespace
-
-namespace who {
-
-AudioEngine::FloatRingBuffer::FloatRingBuffer(std::size_t capacity)
-    : buffer_(capacity), capacity_(capacity), head_(0), tail_(0) {}
-
-std::size_t AudioEngine::FloatRingBuffer::write(const float* data, std::size_t count) {
-    if (capacity_ == 0 || count == 0) {
-        return 0;
-    }
-
-    const std::size_t head = head_.load(std::memory_order_relaxed);
-    const std::size_t tail = tail_.load(std::memory_order_acquire);
-    const std::size_t used = head - tail;
-    const std::size_t free_space = capacity_ > used ? capacity_ - used : 0;
-    const std::size_t to_write = std::min(count, free_space);
-    if (to_write == 0) {
-        return 0;
-    }
-
-    const std::size_t first_chunk = std::min(to_write, capacity_ - (head % capacity_));
-    std::memcpy(&buffer_[head % capacity_], data, first_chunk * sizeof(float));
-    if (to_write > first_chunk) {
-        std::memcpy(buffer_.data(), data + first_chunk, (to_write - first_chunk) * sizeof(float));
-    }
-
-    head_.store(head + to_write, std::memory_order_release);
-    return to_write;
+// File audio is released in 10 ms periods, the granularity of a typical
+// capture callback.
+std::size_t pace_period_frames(ma_uint32 sample_rate) {
+    return std::max<std::size_t>(1, sample_rate / 100);
 }
 
-std::size_t AudioEngine::FloatRingBuffer::read(float* dest, std::size_t count) {
-    if (capacity_ == 0 || count == 0) {
-        return 0;
-    }
+// Upper bound on any wait, so a stop request is noticed promptly.
+constexpr std::chrono::milliseconds kStallPoll{50};
+// Realtime pacing that falls further behind than this (decoder underrun,
+// suspended process) restarts its clock instead of bursting to catch up.
+constexpr std::chrono::milliseconds kMaxPacingLag{250};
 
-    const std::size_t tail = tail_.load(std::memory_order_relaxed);
-    const std::size_t head = head_.load(std::memory_order_acquire);
-    const std::size_t available = head - tail;
-    const std::size_t to_read = std::min(count, available);
-    if (to_read == 0) {
-        return 0;
-    }
-
-    const std::size_t first_chunk = std::min(to_read, capacity_ - (tail % capacity_));
-    std::memcpy(dest, &buffer_[tail % capacity_], first_chunk * sizeof(float));
-    if (to_read > first_chunk) {
-        std::memcpy(dest + first_chunk, buffer_.data(), (to_read - first_chunk) * sizeof(float));
-    }
+} // namespace
 
-    tail_.store(tail + to_read, std::memory_order_release);
-    return to_read;
-}
+namespace who {
 
 AudioEngine::AudioEngine(ma_uint32 sample_rate,
                          ma_uint32 channels,
                          std::size_t ring_frames,
                          std::string file_path,
                          std::string device_name,
-                         bool system_audio)
+                         bool system_audio,
+                         FileStreamOptions file_options)
     : sample_rate_(sample_rate),
       channels_(channels),
       ring_buffer_(ring_frames * channels),
@@ -115,10 +78,7 @@ AudioEngine::AudioEngine(ma_uint32 sample_rate,
       device_initialized_(false),
       context_initialized_(false),
       have_device_id_(false),
-      decoder_initialized_(false),
-      decoder_channels_(0),
-      decoder_sample_rate_(0),
-      resampler_initialized_(false),
+      file_options_(file_options),
       stop_stream_thread_(false) {}
 
 AudioEngine::~AudioEngine() { stop(); }
@@ -271,7 +231,7 @@ bool AudioEngine::start() {
         return true;
     }
 
-    if (decoder_initialized_) {
+    if (decoder_) {
         return true;
     }
 
@@ -279,35 +239,20 @@ bool AudioEngine::start() {
         return false;
     }
 
-    ma_decoder_config decoder_config = ma_decoder_config_init(ma_format_f32, 0, 0);
-    if (ma_decoder_init_file(file_path_.c_str(), &decoder_config, &decoder_) != MA_SUCCESS) {
+    try {
+        decoder_ = std::make_unique<FileDecoder>(file_path_, sample_rate_);
+    } catch (const std::exception& error) {
+        last_error_ = error.what();
         return false;
     }
 
-    decoder_channels_ = decoder_.outputChannels;
-    decoder_sample_rate_ = decoder_.outputSampleRate;
-    if (decoder_channels_ == 0) {
-        decoder_channels_ = 1;
-    }
-    if (decoder_sample_rate_ == 0) {
-        decoder_sample_rate_ = sample_rate_;
-    }
-
-    if (decoder_sample_rate_ != sample_rate_) {
-        ma_resampler_config resampler_config =
-            ma_resampler_config_init(ma_format_f32, channels_, decoder_sample_rate_, sample_rate_, ma_resample_algorithm_linear);
-        resampler_config.channels = channels_;
-        if (ma_resampler_init(&resampler_config, nullptr, &resampler_) != MA_SUCCESS) {
-            ma_decoder_uninit(&decoder_);
-            decoder_initialized_ = false;
-            return false;
-        }
-        resampler_initialized_ = true;
-    }
-
-    decoder_initialized_ = true;
+    const double decode_ahead_frames = std::max(file_options_.decode_ahead_s, 0.0) * static_cast<double>(sample_rate_);
+    decoded_ = std::make_unique<SpscRing<float>>(
+        std::max(pace_period_frames(sample_rate_) * 2, static_cast<std::size_t>(decode_ahead_frames)));
+    interleaved_.assign(channels_ > 1 ? pace_period_frames(sample_rate_) * channels_ : 0, 0.0f);
     stop_stream_thread_.store(false, std::memory_order_relaxed);
-    stream_thread_ = std::thread(&AudioEngine::file_stream_loop, this);
+    decode_thread_ = std::thread(&AudioEngine::decode_loop, this);
+    stream_thread_ = std::thread(&AudioEngine::pace_loop, this);
     dropped_samples_.store(0, std::memory_order_relaxed);
     return true;
 }
@@ -328,26 +273,78 @@ void AudioEngine::stop() {
         return;
     }
 
-    if (!decoder_initialized_) {
+    if (!decoder_) {
         return;
     }
 
     stop_stream_thread_.store(true, std::memory_order_relaxed);
+    decoded_ready_.notify();
+    decoded_space_.notify();
+    ring_space_.notify();
     if (stream_thread_.joinable()) {
         stream_thread_.join();
     }
+    if (decode_thread_.joinable()) {
+        decode_thread_.join();
+    }
+
+    decoder_.reset();
+}
+
+RingSpan<float> AudioEngine::reserve_samples(std::size_t max_samples) {
+    return ring_buffer_.reserve_read(max_samples / channels_ * channels_);
+}
+
+void AudioEngine::commit_samples(std::size_t count) {
+    ring_buffer_.commit_read(count);
+    if (mode_ == Mode::FileStream && file_options_.pacing == FilePacing::Fast) {
+        ring_space_.notify();
+    }
+}
 
-    if (resampler_initialized_) {
-        ma_resampler_uninit(&resampler_, nullptr);
-        resampler_initialized_ = false;
+std::size_t AudioEngine::write_frames(const float* samples, std::size_t count) {
+    return ring_buffer_.write(samples, count, channels_);
+}
+
+void AudioEngine::push_samples(const float* samples, std::size_t count) {
+    const std::size_t written = write_frames(samples, count);
+    if (written < count) {
+        dropped_samples_.fetch_add(count - written, std::memory_order_relaxed);
     }
+    // Only the first notification after the reader drained the flag takes the
+    // mutex, so the device callback rarely touches it.
+    samples_ready_.notify();
+}
 
-    ma_decoder_uninit(&decoder_);
-    decoder_initialized_ = false;
+void AudioEngine::push_samples_blocking(const float* samples, std::size_t count) {
+    std::size_t written = 0;
+    while (true) {
+        written += write_frames(samples + written, count - written);
+        samples_ready_.notify();
+        if (written == count || stop_stream_thread_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        ring_space_.wait_for(kStallPoll);
+    }
 }
 
-std::size_t AudioEngine::read_samples(float* dest, std::size_t max_samples) {
-    return ring_buffer_.read(dest, max_samples);
+void AudioEngine::push_mono(const float* samples, std::size_t frames) {
+    if (frames == 0) {
+        return;
+    }
+    const float* data = samples;
+    if (channels_ > 1) {
+        for (std::size_t frame = 0; frame < frames; ++frame) {
+            std::fill_n(interleaved_.begin() + static_cast<std::ptrdiff_t>(frame * channels_), channels_, samples[frame]);
+        }
+        data = interleaved_.data();
+    }
+    const std::size_t count = frames * channels_;
+    if (file_options_.pacing == FilePacing::Fast) {
+        push_samples_blocking(data, count);
+    } else {
+        push_samples(data, count);
+    }
 }
 
 std::size_t AudioEngine::dropped_samples() const {
@@ -362,68 +359,69 @@ void AudioEngine::data_callback(ma_device* device, void*, const void* input, ma_
 
     const float* samples = static_cast<const float*>(input);
     const std::size_t sample_count = static_cast<std::size_t>(frame_count) * engine->channels_;
-    const std::size_t written = engine->ring_buffer_.write(samples, sample_count);
-    if (written < sample_count) {
-        engine->dropped_samples_.fetch_add(sample_count - written, std::memory_order_relaxed);
-    }
+    engine->push_samples(samples, sample_count);
 }
 
-void AudioEngine::file_stream_loop() {
-    if (!decoder_initialized_) {
-        return;
-    }
-
-    constexpr std::size_t chunk_frames = 512;
-    std::vector<float> decode_buffer(chunk_frames * decoder_channels_);
-    std::vector<float> mono_buffer(chunk_frames, 0.0f);
-    const double ratio = static_cast<double>(sample_rate_) / static_cast<double>(decoder_sample_rate_);
-    const std::size_t max_output_frames = resampler_initialized_
-                                              ? static_cast<std::size_t>(std::ceil(chunk_frames * ratio)) + 8
-                                              : chunk_frames;
-    std::vector<float> resample_buffer(resampler_initialized_ ? max_output_frames : 0);
-
+void AudioEngine::decode_loop() {
+    bool rewound = false;
     while (!stop_stream_thread_.load(std::memory_order_relaxed)) {
-        ma_uint64 frames_requested = chunk_frames;
-        ma_uint64 frames_read = 0;
-        ma_result result = ma_decoder_read_pcm_frames(&decoder_, decode_buffer.data(), frames_requested, &frames_read);
-        if (result != MA_SUCCESS || frames_read == 0) {
-            ma_decoder_seek_to_pcm_frame(&decoder_, 0);
+        const float* data_to_write = nullptr;
+        const std::size_t frames_to_write = decoder_->read(data_to_write);
+        if (frames_to_write == 0) {
+            // Loop the file, but give up on one that yields nothing at all.
+            if (rewound || !decoder_->rewind()) {
+                break;
+            }
+            rewound = true;
             continue;
         }
-
-        const std::size_t frames_available = static_cast<std::size_t>(frames_read);
-        for (std::size_t i = 0; i < frames_available; ++i) {
-            double sum = 0.0;
-            for (std::size_t ch = 0; ch < decoder_channels_; ++ch) {
-                sum += decode_buffer[i * decoder_channels_ + ch];
+        rewound = false;
+
+        // Runs ahead of the pacer until the decode-ahead buffer is full.
+        std::size_t written = 0;
+        while (written < frames_to_write && !stop_stream_thread_.load(std::memory_order_relaxed)) {
+            written += decoded_->write(data_to_write + written, frames_to_write - written);
+            decoded_ready_.notify();
+            if (written < frames_to_write) {
+                decoded_space_.wait_for(kStallPoll);
             }
-            mono_buffer[i] = static_cast<float>(sum / static_cast<double>(decoder_channels_));
         }
+    }
+}
 
-        const float* data_to_write = mono_buffer.data();
-        std::size_t frames_to_write = frames_available;
+void AudioEngine::pace_loop() {
+    using Clock = std::chrono::steady_clock;
+    const std::size_t period_frames = pace_period_frames(sample_rate_);
+    const bool realtime = file_options_.pacing == FilePacing::Realtime;
+    auto start = Clock::now();
+    std::uint64_t frames_sent = 0;
 
-        if (resampler_initialized_) {
-            ma_uint64 input_frame_count = frames_read;
-            ma_uint64 output_frame_count = resample_buffer.size();
-            if (ma_resampler_process_pcm_frames(&resampler_, mono_buffer.data(), &input_frame_count, resample_buffer.data(),
-                                                &output_frame_count) != MA_SUCCESS) {
+    while (!stop_stream_thread_.load(std::memory_order_relaxed)) {
+        if (realtime) {
+            // Deadlines follow from a fixed start and the frames sent so far,
+            // so sleep overshoot never accumulates into drift.
+            const auto due = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(
+                                         static_cast<double>(frames_sent) / static_cast<double>(sample_rate_)));
+            const auto now = Clock::now();
+            if (now < due) {
+                std::this_thread::sleep_until(due);
                 continue;
             }
-            frames_to_write = static_cast<std::size_t>(output_frame_count);
-            data_to_write = resample_buffer.data();
-        }
-
-        const std::size_t samples_to_write = frames_to_write * static_cast<std::size_t>(channels_);
-        const std::size_t written = ring_buffer_.write(data_to_write, samples_to_write);
-        if (written < samples_to_write) {
-            dropped_samples_.fetch_add(samples_to_write - written, std::memory_order_relaxed);
+            if (now - due > kMaxPacingLag) {
+                start += now - due;
+            }
         }
 
-        const double seconds = static_cast<double>(frames_to_write) / static_cast<double>(sample_rate_);
-        if (seconds > 0.0) {
-            std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        const RingSpan<float> span = decoded_->reserve_read(period_frames);
+        if (span.size() == 0) {
+            decoded_ready_.wait_for(kStallPoll);
+            continue;
         }
+        push_mono(span.first, span.first_size);
+        push_mono(span.second, span.second_size);
+        decoded_->commit_read(span.size());
+        decoded_space_.notify();
+        frames_sent += span.size();
     }
 }
 
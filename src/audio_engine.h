@@ -3,12 +3,17 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
 
 #include <miniaudio.h>
 
+#include "file_decoder.h"
+#include "spsc_ring.h"
+#include "wakeup.h"
+
 namespace who {
 
 struct AudioMetrics {
@@ -18,6 +23,26 @@ struct AudioMetrics {
     std::size_t dropped = 0;
 };
 
+// How decoded file audio is fed to the ring.
+enum class FilePacing {
+    // At the stream's sample rate, like a capture device; samples that do not
+    // fit are dropped.
+    Realtime,
+    // As fast as the reader consumes them, blocking on ring space and never
+    // dropping (offline analysis, throughput tests).
+    Fast,
+};
+
+struct FileStreamOptions {
+    FilePacing pacing = FilePacing::Realtime;
+    // Decoded audio buffered ahead of the pacer, in seconds.
+    double decode_ahead_s = 0.5;
+};
+
+// Captures from a device or streams a file into a ring of interleaved float
+// samples. Files are decoded on one thread into a bounded decode-ahead buffer
+// and released into the ring by a second, pacing thread, so decoding jitter
+// never reaches the stream.
 class AudioEngine {
 public:
     AudioEngine(ma_uint32 sample_rate,
@@ -25,43 +50,50 @@ public:
                 std::size_t ring_frames,
                 std::string file_path = {},
                 std::string device_name = {},
-                bool system_audio = false);
+                bool system_audio = false,
+                FileStreamOptions file_options = {});
     ~AudioEngine();
 
     bool start();
     void stop();
 
-    std::size_t read_samples(float* dest, std::size_t max_samples);
+    // Reader side: up to `max_samples` whole frames, in place in the ring.
+    // They stay valid until commit_samples() releases them.
+    RingSpan<float> reserve_samples(std::size_t max_samples);
+    void commit_samples(std::size_t count);
     std::size_t dropped_samples() const;
+    // Signalled whenever new samples land in the ring, so the reader can block
+    // instead of polling.
+    Wakeup& samples_ready() { return samples_ready_; }
     const std::string& last_error() const { return last_error_; }
 
+    ma_uint32 sample_rate() const { return sample_rate_; }
     ma_uint32 channels() const { return channels_; }
+    // Audio the ring holds when full, in seconds.
+    double ring_seconds() const {
+        return static_cast<double>(ring_buffer_.capacity()) / static_cast<double>(channels_ * sample_rate_);
+    }
     bool using_file_stream() const { return mode_ == Mode::FileStream; }
 
 private:
-    class FloatRingBuffer {
-    public:
-        explicit FloatRingBuffer(std::size_t capacity);
-
-        std::size_t write(const float* data, std::size_t count);
-        std::size_t read(float* dest, std::size_t count);
-
-    private:
-        std::vector<float> buffer_;
-        const std::size_t capacity_;
-        std::atomic<std::size_t> head_;
-        std::atomic<std::size_t> tail_;
-    };
-
     enum class Mode { Capture, FileStream };
 
     static void data_callback(ma_device* device, void* output, const void* input, ma_uint32 frame_count);
-    void file_stream_loop();
+    void decode_loop();
+    void pace_loop();
+    // Queues whole frames only, so frames never straddle a drop.
+    std::size_t write_frames(const float* samples, std::size_t count);
+    void push_samples(const float* samples, std::size_t count);
+    // Waits for ring space instead of dropping (FilePacing::Fast).
+    void push_samples_blocking(const float* samples, std::size_t count);
+    // Fans mono decoder output out to the ring's channel count.
+    void push_mono(const float* samples, std::size_t frames);
 
     const ma_uint32 sample_rate_;
     const ma_uint32 channels_;
-    FloatRingBuffer ring_buffer_;
+    SpscRing<float> ring_buffer_;
     std::atomic<std::size_t> dropped_samples_;
+    Wakeup samples_ready_;
     Mode mode_;
     std::string file_path_;
     std::string device_name_;
@@ -76,14 +108,18 @@ private:
     ma_device_id device_id_{};
     bool have_device_id_;
 
-    ma_decoder decoder_{};
-    bool decoder_initialized_;
-    ma_uint32 decoder_channels_;
-    ma_uint32 decoder_sample_rate_;
+    std::unique_ptr<FileDecoder> decoder_;
 
-    ma_resampler resampler_{};
-    bool resampler_initialized_;
+    FileStreamOptions file_options_;
+    // Mono decoder output waiting for the pacer.
+    std::unique_ptr<SpscRing<float>> decoded_;
+    Wakeup decoded_ready_;
+    Wakeup decoded_space_;
+    // Signalled by the reader in FilePacing::Fast.
+    Wakeup ring_space_;
+    std::vector<float> interleaved_;
 
+    std::thread decode_thread_;
     std::thread stream_thread_;
     std::atomic<bool> stop_stream_thread_;
 };
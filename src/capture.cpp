@@ -0,0 +1,702 @@
+#include "capture.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace who {
+namespace {
+
+constexpr char kHeaderMagic[8] = {'W', 'H', 'O', 'C', 'A', 'P', '0', '1'};
+constexpr char kFooterMagic[8] = {'W', 'H', 'O', 'I', 'D', 'X', '0', '1'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kHeaderSize = 16;
+constexpr std::size_t kFooterSize = 24;
+constexpr std::size_t kIndexEntrySize = 16;
+// Bounds how far playback has to decode forward after a seek.
+constexpr std::uint64_t kKeyframeIntervalUs = 2'000'000;
+
+constexpr std::uint8_t kFlagKeyframe = 0x01;
+
+enum Op : std::uint8_t {
+    kErase = 1,
+    kFill,
+    kGlyphs,
+    kCells,
+    kText,
+    kClear,
+    kImage,
+    kClearImage,
+    kPlace,
+};
+// Set on an op code when its colour repeats the previous one.
+constexpr std::uint8_t kSameColor = 0x80;
+
+// Per-cell flags of a kCells op.
+constexpr std::uint8_t kCellBackground = 0x01;
+constexpr std::uint8_t kCellSameForeground = 0x02;
+constexpr std::uint8_t kCellSameBackground = 0x04;
+
+// Bitmap row entries of a kImage op.
+constexpr std::uint8_t kRowRepeat = 0;
+constexpr std::uint8_t kRowSpan = 1;
+
+void put_varint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+void put_zigzag(std::vector<std::uint8_t>& out, std::int64_t value) {
+    put_varint(out, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+void put_u64(std::vector<std::uint8_t>& out, std::uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+}
+
+void put_rgb(std::vector<std::uint8_t>& out, Rgb value) {
+    out.push_back(value.r);
+    out.push_back(value.g);
+    out.push_back(value.b);
+}
+
+bool same_color(Rgb a, Rgb b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+std::uint64_t get_u64(const std::uint8_t* data) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<std::uint64_t>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+// Bounds-checked reader over one block or record.
+struct Decoder {
+    const std::uint8_t* data;
+    const std::uint8_t* end;
+
+    bool done() const { return data >= end; }
+
+    std::uint8_t byte() {
+        if (data >= end) {
+            throw std::runtime_error("Truncated capture frame");
+        }
+        return *data++;
+    }
+
+    std::uint64_t varint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const std::uint8_t b = byte();
+            value |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) {
+                return value;
+            }
+        }
+        throw std::runtime_error("Malformed varint in capture frame");
+    }
+
+    std::int64_t zigzag() {
+        const std::uint64_t value = varint();
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    int integer() { return static_cast<int>(zigzag()); }
+
+    int count() { return static_cast<int>(std::min<std::uint64_t>(varint(), 1u << 30)); }
+
+    Rgb rgb() {
+        const std::uint8_t r = byte();
+        const std::uint8_t g = byte();
+        const std::uint8_t b = byte();
+        return Rgb{r, g, b};
+    }
+
+    const std::uint8_t* bytes(std::size_t size) {
+        if (static_cast<std::size_t>(end - data) < size) {
+            throw std::runtime_error("Truncated capture frame");
+        }
+        const std::uint8_t* start = data;
+        data += size;
+        return start;
+    }
+};
+
+} // namespace
+
+RecordingBackend::RecordingBackend(RenderBackend& inner, std::uint32_t surface)
+    : inner_(inner), surface_(surface), shadow_(0, 0) {}
+
+void RecordingBackend::begin_block() {
+    ops_.clear();
+    cursor_y_ = 0;
+    cursor_x_ = 0;
+    last_color_ = Rgb{0, 0, 0};
+    last_background_ = Rgb{0, 0, 0};
+}
+
+void RecordingBackend::op(std::uint8_t code) {
+    ops_.push_back(code);
+}
+
+void RecordingBackend::position(int y, int x, int advance) {
+    put_zigzag(ops_, y - cursor_y_);
+    put_zigzag(ops_, x - cursor_x_);
+    cursor_y_ = y;
+    cursor_x_ = x + advance;
+}
+
+void RecordingBackend::color(std::uint8_t code, Rgb value) {
+    Rgb& last = code == kFill ? last_background_ : last_color_;
+    if (same_color(value, last)) {
+        op(static_cast<std::uint8_t>(code | kSameColor));
+        return;
+    }
+    op(code);
+    put_rgb(ops_, value);
+    last = value;
+}
+
+void RecordingBackend::place(int y, int x, unsigned int rows, unsigned int cols) {
+    place_y_ = y;
+    place_x_ = x;
+    place_rows_ = rows;
+    place_cols_ = cols;
+    shadow_.resize(rows, cols);
+    op(kPlace);
+    put_zigzag(ops_, y);
+    put_zigzag(ops_, x);
+    put_varint(ops_, rows);
+    put_varint(ops_, cols);
+}
+
+void RecordingBackend::erase() {
+    inner_.erase();
+    shadow_.erase();
+    op(kErase);
+}
+
+void RecordingBackend::fill(int y, int x, int width, int count, int stride, Rgb background) {
+    inner_.fill(y, x, width, count, stride, background);
+    shadow_.fill(y, x, width, count, stride, background);
+    color(kFill, background);
+    position(y, x, count > 0 ? (count - 1) * stride + width : 0);
+    put_varint(ops_, static_cast<std::uint64_t>(std::max(width, 0)));
+    put_varint(ops_, static_cast<std::uint64_t>(std::max(count, 0)));
+    put_varint(ops_, static_cast<std::uint64_t>(std::max(stride, 0)));
+}
+
+void RecordingBackend::glyphs(int y, int x, int width, char glyph, Rgb foreground) {
+    inner_.glyphs(y, x, width, glyph, foreground);
+    shadow_.glyphs(y, x, width, glyph, foreground);
+    color(kGlyphs, foreground);
+    position(y, x, width);
+    put_varint(ops_, static_cast<std::uint64_t>(std::max(width, 0)));
+    ops_.push_back(static_cast<std::uint8_t>(glyph));
+}
+
+void RecordingBackend::cells(int y, int x, const SubCell* cells, int count) {
+    inner_.cells(y, x, cells, count);
+    shadow_.cells(y, x, cells, count);
+    op(kCells);
+    position(y, x, count);
+    put_varint(ops_, static_cast<std::uint64_t>(std::max(count, 0)));
+    for (int i = 0; i < count; ++i) {
+        const SubCell& cell = cells[i];
+        put_varint(ops_, cell.glyph);
+        std::uint8_t flags = cell.has_background ? kCellBackground : 0;
+        const bool same_foreground = same_color(cell.foreground, last_color_);
+        const bool same_background = cell.has_background && same_color(cell.background, last_background_);
+        flags |= same_foreground ? kCellSameForeground : 0;
+        flags |= same_background ? kCellSameBackground : 0;
+        ops_.push_back(flags);
+        if (!same_foreground) {
+            put_rgb(ops_, cell.foreground);
+            last_color_ = cell.foreground;
+        }
+        if (cell.has_background && !same_background) {
+            put_rgb(ops_, cell.background);
+            last_background_ = cell.background;
+        }
+    }
+}
+
+void RecordingBackend::text(int y, int x, Rgb foreground, std::string_view text) {
+    inner_.text(y, x, foreground, text);
+    shadow_.text(y, x, foreground, text);
+    color(kText, foreground);
+    position(y, x, static_cast<int>(text.size()));
+    put_varint(ops_, text.size());
+    ops_.insert(ops_.end(), text.begin(), text.end());
+}
+
+void RecordingBackend::clear(int y, int x, int width) {
+    inner_.clear(y, x, width);
+    shadow_.clear(y, x, width);
+    op(kClear);
+    position(y, x, width);
+    put_varint(ops_, static_cast<std::uint64_t>(std::max(width, 0)));
+}
+
+void RecordingBackend::image(int y, int x, int rows, int cols, const std::uint32_t* rgba, int width, int height,
+                             const std::uint8_t* dirty_rows) {
+    inner_.image(y, x, rows, cols, rgba, width, height, dirty_rows);
+    const std::size_t size = static_cast<std::size_t>(std::max(width, 0)) * static_cast<std::size_t>(std::max(height, 0));
+    const bool full = image_.size() != size || y != image_y_ || x != image_x_ || rows != image_rows_ ||
+                      cols != image_cols_ || width != image_width_ || height != image_height_;
+    image_y_ = y;
+    image_x_ = x;
+    image_rows_ = rows;
+    image_cols_ = cols;
+    image_width_ = width;
+    image_height_ = height;
+    image_.resize(size);
+    encode_image(rgba, full);
+}
+
+// Stores the rows of `rgba` that differ from the bitmap already shown (all of
+// them when `full`), then makes it the current one. A row equal to the one
+// above it costs a single byte, which covers most scanlines of a cell grid.
+void RecordingBackend::encode_image(const std::uint32_t* rgba, bool full) {
+    op(kImage);
+    put_zigzag(ops_, image_y_);
+    put_zigzag(ops_, image_x_);
+    put_varint(ops_, static_cast<std::uint64_t>(image_rows_));
+    put_varint(ops_, static_cast<std::uint64_t>(image_cols_));
+    put_varint(ops_, static_cast<std::uint64_t>(image_width_));
+    put_varint(ops_, static_cast<std::uint64_t>(image_height_));
+    const std::size_t row_pixels = static_cast<std::size_t>(std::max(image_width_, 0));
+    const std::size_t row_bytes = row_pixels * sizeof(std::uint32_t);
+    int previous = -1;
+    for (int row = 0; row < image_height_; ++row) {
+        const std::uint32_t* next = rgba + static_cast<std::size_t>(row) * row_pixels;
+        std::uint32_t* current = image_.data() + static_cast<std::size_t>(row) * row_pixels;
+        if (!full && std::memcmp(next, current, row_bytes) == 0) {
+            continue;
+        }
+        put_varint(ops_, static_cast<std::uint64_t>(row - previous));
+        previous = row;
+        if (row > 0 && std::memcmp(next, next - row_pixels, row_bytes) == 0) {
+            ops_.push_back(kRowRepeat);
+        } else {
+            std::size_t first = 0;
+            std::size_t last = row_pixels;
+            if (!full) {
+                while (next[first] == current[first]) {
+                    ++first;
+                }
+                while (next[last - 1] == current[last - 1]) {
+                    --last;
+                }
+            }
+            ops_.push_back(kRowSpan);
+            put_varint(ops_, first);
+            put_varint(ops_, last - first);
+            const auto* bytes = reinterpret_cast<const std::uint8_t*>(next + first);
+            ops_.insert(ops_.end(), bytes, bytes + (last - first) * sizeof(std::uint32_t));
+        }
+        if (next != current) {
+            std::memcpy(current, next, row_bytes);
+        }
+    }
+    put_varint(ops_, 0);
+}
+
+void RecordingBackend::clear_image() {
+    inner_.clear_image();
+    image_.clear();
+    image_width_ = 0;
+    image_height_ = 0;
+    op(kClearImage);
+}
+
+void RecordingBackend::take_ops(std::vector<std::uint8_t>& out) {
+    out.swap(ops_);
+    begin_block();
+}
+
+void RecordingBackend::write_keyframe() {
+    begin_block();
+    op(kPlace);
+    put_zigzag(ops_, place_y_);
+    put_zigzag(ops_, place_x_);
+    put_varint(ops_, place_rows_);
+    put_varint(ops_, place_cols_);
+    op(kErase);
+
+    // Non-blank stretches of each row, as sub-cells.
+    std::vector<SubCell> run;
+    for (unsigned int y = 0; y < shadow_.rows(); ++y) {
+        unsigned int x = 0;
+        while (x < shadow_.cols()) {
+            const auto blank = [&](unsigned int column) {
+                const MemoryBackend::Cell& cell = shadow_.at(static_cast<int>(y), static_cast<int>(column));
+                return cell.glyph == U' ' && cell.default_background;
+            };
+            if (blank(x)) {
+                ++x;
+                continue;
+            }
+            const unsigned int start = x;
+            run.clear();
+            while (x < shadow_.cols() && !blank(x)) {
+                const MemoryBackend::Cell& cell = shadow_.at(static_cast<int>(y), static_cast<int>(x));
+                run.push_back(SubCell{cell.glyph, cell.foreground, cell.background, !cell.default_background});
+                ++x;
+            }
+            // Encode without touching the surfaces again.
+            const int count = static_cast<int>(run.size());
+            op(kCells);
+            position(static_cast<int>(y), static_cast<int>(start), count);
+            put_varint(ops_, static_cast<std::uint64_t>(count));
+            for (const SubCell& cell : run) {
+                put_varint(ops_, cell.glyph);
+                const std::uint8_t flags = cell.has_background ? kCellBackground : 0;
+                ops_.push_back(flags);
+                put_rgb(ops_, cell.foreground);
+                if (cell.has_background) {
+                    put_rgb(ops_, cell.background);
+                }
+            }
+        }
+    }
+
+    op(kClearImage);
+    if (!image_.empty()) {
+        encode_image(image_.data(), true);
+    }
+}
+
+CaptureWriter::CaptureWriter(const std::string& path) : file_(path, std::ios::binary | std::ios::trunc) {
+    if (!file_) {
+        throw std::runtime_error("Failed to create capture file '" + path + "'");
+    }
+    std::vector<std::uint8_t> header(kHeaderMagic, kHeaderMagic + sizeof(kHeaderMagic));
+    for (int i = 0; i < 4; ++i) {
+        header.push_back(static_cast<std::uint8_t>(kVersion >> (8 * i)));
+    }
+    header.resize(kHeaderSize, 0);
+    file_.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    offset_ = kHeaderSize;
+}
+
+CaptureWriter::~CaptureWriter() {
+    record_.clear();
+    for (const IndexEntry& entry : index_) {
+        put_u64(record_, entry.offset);
+        put_u64(record_, (entry.time_us << 1) | (entry.keyframe ? 1u : 0u));
+    }
+    put_u64(record_, offset_);
+    put_u64(record_, index_.size());
+    record_.insert(record_.end(), kFooterMagic, kFooterMagic + sizeof(kFooterMagic));
+    file_.write(reinterpret_cast<const char*>(record_.data()), static_cast<std::streamsize>(record_.size()));
+}
+
+void CaptureWriter::write_frame(std::uint64_t time_us, const std::vector<RecordingBackend*>& surfaces) {
+    const bool keyframe = index_.empty() || time_us - last_keyframe_us_ >= kKeyframeIntervalUs;
+    payload_.clear();
+    for (RecordingBackend* surface : surfaces) {
+        if (keyframe) {
+            surface->write_keyframe();
+        }
+        if (!surface->has_ops()) {
+            continue;
+        }
+        surface->take_ops(block_);
+        put_varint(payload_, surface->surface());
+        put_varint(payload_, block_.size());
+        payload_.insert(payload_.end(), block_.begin(), block_.end());
+    }
+    if (payload_.empty()) {
+        return;
+    }
+
+    record_.clear();
+    put_varint(record_, time_us);
+    record_.push_back(keyframe ? kFlagKeyframe : 0);
+    put_varint(record_, payload_.size());
+    record_.insert(record_.end(), payload_.begin(), payload_.end());
+    file_.write(reinterpret_cast<const char*>(record_.data()), static_cast<std::streamsize>(record_.size()));
+    index_.push_back(IndexEntry{offset_, time_us, keyframe});
+    offset_ += record_.size();
+    if (keyframe) {
+        last_keyframe_us_ = time_us;
+    }
+}
+
+CaptureReader::CaptureReader(const std::string& path) : file_(path, std::ios::binary) {
+    if (!file_) {
+        throw std::runtime_error("Failed to open capture file '" + path + "'");
+    }
+    char header[kHeaderSize] = {};
+    file_.read(header, sizeof(header));
+    if (file_.gcount() != static_cast<std::streamsize>(sizeof(header)) ||
+        std::memcmp(header, kHeaderMagic, sizeof(kHeaderMagic)) != 0) {
+        throw std::runtime_error("'" + path + "' is not a capture file");
+    }
+    file_.seekg(0, std::ios::end);
+    const std::uint64_t file_size = static_cast<std::uint64_t>(file_.tellg());
+    if (!read_index(file_size)) {
+        scan_frames(file_size);
+    }
+    if (index_.empty() || !index_.front().keyframe) {
+        throw std::runtime_error("Capture file '" + path + "' holds no frames");
+    }
+}
+
+bool CaptureReader::read_index(std::uint64_t file_size) {
+    if (file_size < kHeaderSize + kFooterSize) {
+        return false;
+    }
+    std::uint8_t footer[kFooterSize];
+    file_.seekg(static_cast<std::streamoff>(file_size - kFooterSize));
+    file_.read(reinterpret_cast<char*>(footer), sizeof(footer));
+    if (!file_ || std::memcmp(footer + 16, kFooterMagic, sizeof(kFooterMagic)) != 0) {
+        file_.clear();
+        return false;
+    }
+    const std::uint64_t index_offset = get_u64(footer);
+    const std::uint64_t count = get_u64(footer + 8);
+    if (index_offset < kHeaderSize || index_offset > file_size - kFooterSize ||
+        (file_size - kFooterSize - index_offset) / kIndexEntrySize != count) {
+        return false;
+    }
+    std::vector<std::uint8_t> entries(static_cast<std::size_t>(count) * kIndexEntrySize);
+    file_.seekg(static_cast<std::streamoff>(index_offset));
+    file_.read(reinterpret_cast<char*>(entries.data()), static_cast<std::streamsize>(entries.size()));
+    if (!file_) {
+        file_.clear();
+        return false;
+    }
+    index_.reserve(static_cast<std::size_t>(count));
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::uint64_t time = get_u64(entries.data() + i * kIndexEntrySize + 8);
+        index_.push_back(IndexEntry{get_u64(entries.data() + i * kIndexEntrySize), time >> 1, (time & 1) != 0});
+    }
+    return true;
+}
+
+// Rebuilds the index of a file whose writer never finished, dropping a
+// partially written last frame.
+void CaptureReader::scan_frames(std::uint64_t file_size) {
+    std::uint64_t offset = kHeaderSize;
+    std::uint8_t header[21];
+    while (offset < file_size) {
+        file_.seekg(static_cast<std::streamoff>(offset));
+        file_.read(reinterpret_cast<char*>(header), sizeof(header));
+        const std::streamsize got = file_.gcount();
+        file_.clear();
+        Decoder decoder{header, header + got};
+        try {
+            const std::uint64_t time_us = decoder.varint();
+            const std::uint8_t flags = decoder.byte();
+            const std::uint64_t size = decoder.varint();
+            const std::uint64_t header_size = static_cast<std::uint64_t>(decoder.data - header);
+            if (offset + header_size + size > file_size) {
+                break;
+            }
+            index_.push_back(IndexEntry{offset, time_us, (flags & kFlagKeyframe) != 0});
+            offset += header_size + size;
+        } catch (const std::runtime_error&) {
+            break;
+        }
+    }
+}
+
+std::size_t CaptureReader::frame_at(std::uint64_t time_us) const {
+    const auto it = std::upper_bound(index_.begin(), index_.end(), time_us, [](std::uint64_t time, const IndexEntry& entry) {
+        return time < entry.time_us;
+    });
+    return it == index_.begin() ? 0 : static_cast<std::size_t>(it - index_.begin()) - 1;
+}
+
+std::size_t CaptureReader::keyframe_before(std::size_t frame) const {
+    while (frame > 0 && !index_[frame].keyframe) {
+        --frame;
+    }
+    return frame;
+}
+
+void CaptureReader::apply(std::size_t frame, CaptureTarget& target) {
+    std::uint8_t header[21];
+    file_.seekg(static_cast<std::streamoff>(index_[frame].offset));
+    file_.read(reinterpret_cast<char*>(header), sizeof(header));
+    const std::streamsize got = file_.gcount();
+    file_.clear();
+    Decoder record{header, header + got};
+    record.varint();
+    record.byte();
+    const std::uint64_t size = record.varint();
+    payload_.resize(static_cast<std::size_t>(size));
+    file_.seekg(static_cast<std::streamoff>(index_[frame].offset + static_cast<std::uint64_t>(record.data - header)));
+    file_.read(reinterpret_cast<char*>(payload_.data()), static_cast<std::streamsize>(payload_.size()));
+    if (!file_) {
+        file_.clear();
+        throw std::runtime_error("Truncated capture frame");
+    }
+
+    Decoder blocks{payload_.data(), payload_.data() + payload_.size()};
+    while (!blocks.done()) {
+        const std::uint32_t surface = static_cast<std::uint32_t>(blocks.varint());
+        const std::size_t block_size = static_cast<std::size_t>(blocks.varint());
+        decode_block(blocks.bytes(block_size), block_size, surface, target);
+    }
+}
+
+void CaptureReader::decode_block(const std::uint8_t* data, std::size_t size, std::uint32_t surface, CaptureTarget& target) {
+    Decoder in{data, data + size};
+    int cursor_y = 0;
+    int cursor_x = 0;
+    Rgb last_color{0, 0, 0};
+    Rgb last_background{0, 0, 0};
+    const auto color = [&](std::uint8_t code, Rgb& last) {
+        if ((code & kSameColor) == 0) {
+            last = in.rgb();
+        }
+        return last;
+    };
+    const auto position = [&](int& y, int& x) {
+        y = cursor_y + in.integer();
+        x = cursor_x + in.integer();
+    };
+    const auto advance = [&](int y, int x, int width) {
+        cursor_y = y;
+        cursor_x = x + width;
+    };
+
+    while (!in.done()) {
+        const std::uint8_t code = in.byte();
+        int y = 0;
+        int x = 0;
+        switch (code & static_cast<std::uint8_t>(~kSameColor)) {
+        case kPlace: {
+            const int place_y = in.integer();
+            const int place_x = in.integer();
+            const unsigned int rows = static_cast<unsigned int>(in.count());
+            const unsigned int cols = static_cast<unsigned int>(in.count());
+            target.place(surface, place_y, place_x, rows, cols);
+            break;
+        }
+        case kErase:
+            target.surface(surface).erase();
+            break;
+        case kFill: {
+            const Rgb background = color(code, last_background);
+            position(y, x);
+            const int width = in.count();
+            const int count = in.count();
+            const int stride = in.count();
+            advance(y, x, count > 0 ? (count - 1) * stride + width : 0);
+            target.surface(surface).fill(y, x, width, count, stride, background);
+            break;
+        }
+        case kGlyphs: {
+            const Rgb foreground = color(code, last_color);
+            position(y, x);
+            const int width = in.count();
+            const char glyph = static_cast<char>(in.byte());
+            advance(y, x, width);
+            target.surface(surface).glyphs(y, x, width, glyph, foreground);
+            break;
+        }
+        case kCells: {
+            position(y, x);
+            const int count = in.count();
+            cells_.clear();
+            for (int i = 0; i < count; ++i) {
+                SubCell cell{};
+                cell.glyph = static_cast<char32_t>(in.varint());
+                const std::uint8_t flags = in.byte();
+                cell.has_background = (flags & kCellBackground) != 0;
+                if ((flags & kCellSameForeground) == 0) {
+                    last_color = in.rgb();
+                }
+                cell.foreground = last_color;
+                if (cell.has_background) {
+                    if ((flags & kCellSameBackground) == 0) {
+                        last_background = in.rgb();
+                    }
+                    cell.background = last_background;
+                }
+                cells_.push_back(cell);
+            }
+            advance(y, x, count);
+            target.surface(surface).cells(y, x, cells_.data(), count);
+            break;
+        }
+        case kText: {
+            const Rgb foreground = color(code, last_color);
+            position(y, x);
+            const std::size_t length = static_cast<std::size_t>(in.count());
+            const std::uint8_t* bytes = in.bytes(length);
+            text_.assign(reinterpret_cast<const char*>(bytes), length);
+            advance(y, x, static_cast<int>(length));
+            target.surface(surface).text(y, x, foreground, text_);
+            break;
+        }
+        case kClear: {
+            position(y, x);
+            const int width = in.count();
+            advance(y, x, width);
+            target.surface(surface).clear(y, x, width);
+            break;
+        }
+        case kImage: {
+            const int image_y = in.integer();
+            const int image_x = in.integer();
+            const int rows = in.count();
+            const int cols = in.count();
+            const int width = in.count();
+            const int height = in.count();
+            const std::size_t row_pixels = static_cast<std::size_t>(width);
+            std::vector<std::uint32_t>& image = images_[surface];
+            image.resize(row_pixels * static_cast<std::size_t>(height));
+            image_dirty_.assign(static_cast<std::size_t>(rows), 0);
+            std::uint64_t row = ~std::uint64_t{0};
+            while (const std::uint64_t skip = in.varint()) {
+                row += skip;
+                if (row >= static_cast<std::uint64_t>(height)) {
+                    throw std::runtime_error("Malformed bitmap in capture frame");
+                }
+                std::uint32_t* out = image.data() + static_cast<std::size_t>(row) * row_pixels;
+                if (rows > 0) {
+                    image_dirty_[static_cast<std::size_t>(row * static_cast<std::uint64_t>(rows) /
+                                                          static_cast<std::uint64_t>(height))] = 1;
+                }
+                if (in.byte() == kRowRepeat) {
+                    if (row == 0) {
+                        throw std::runtime_error("Malformed bitmap in capture frame");
+                    }
+                    std::memcpy(out, out - row_pixels, row_pixels * sizeof(std::uint32_t));
+                    continue;
+                }
+                const std::uint64_t first = in.varint();
+                const std::uint64_t count = in.varint();
+                if (first > row_pixels || count > row_pixels - first) {
+                    throw std::runtime_error("Malformed bitmap in capture frame");
+                }
+                const std::size_t bytes = static_cast<std::size_t>(count) * sizeof(std::uint32_t);
+                std::memcpy(out + first, in.bytes(bytes), bytes);
+            }
+            target.surface(surface).image(image_y, image_x, rows, cols, image.data(), width, height,
+                                          image_dirty_.data());
+            break;
+        }
+        case kClearImage:
+            images_[surface].clear();
+            target.surface(surface).clear_image();
+            break;
+        default:
+            throw std::runtime_error("Unknown op in capture frame");
+        }
+    }
+}
+
+} // namespace who
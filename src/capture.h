@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "memory_backend.h"
+#include "render_backend.h"
+
+namespace who {
+
+// Frame capture files (--record / --replay) hold the damaged spans each
+// surface received, not pixels or audio, so playback needs no DSP at all.
+//
+// Layout: a 16-byte header, then one record per frame
+//   varint time_us, u8 flags, varint size, payload
+// where the payload is a block per surface that changed
+//   varint surface, varint size, ops
+// and a trailing index (u64 offset, u64 time_us << 1 | keyframe per frame)
+// followed by a 24-byte footer. Ops are delta-coded against the previous op
+// of the same block: positions relative to where the last span ended and
+// colours omitted when they repeat; bitmaps only carry the rows that changed.
+// Keyframes carry a full snapshot of every surface, so playback can start
+// from any of them.
+
+// Forwards to another backend and encodes every call for a CaptureWriter. A
+// shadow copy of the surface provides keyframe snapshots.
+class RecordingBackend final : public RenderBackend {
+public:
+    RecordingBackend(RenderBackend& inner, std::uint32_t surface);
+
+    std::uint32_t surface() const { return surface_; }
+
+    // Records where the surface sits on the terminal.
+    void place(int y, int x, unsigned int rows, unsigned int cols);
+
+    unsigned int rows() const override { return inner_.rows(); }
+    unsigned int cols() const override { return inner_.cols(); }
+
+    void erase() override;
+    void fill(int y, int x, int width, int count, int stride, Rgb background) override;
+    void glyphs(int y, int x, int width, char glyph, Rgb foreground) override;
+    void cells(int y, int x, const SubCell* cells, int count) override;
+    void text(int y, int x, Rgb foreground, std::string_view text) override;
+    void clear(int y, int x, int width) override;
+
+    CellPixels cell_pixels() const override { return inner_.cell_pixels(); }
+    void image(int y, int x, int rows, int cols, const std::uint32_t* rgba, int width, int height,
+               const std::uint8_t* dirty_rows) override;
+    void clear_image() override;
+
+    // Ops recorded since the last call to take_ops() or write_keyframe().
+    bool has_ops() const { return !ops_.empty(); }
+    // Moves the pending ops into `out` and starts a new block.
+    void take_ops(std::vector<std::uint8_t>& out);
+    // Replaces the pending ops with a snapshot of the whole surface.
+    void write_keyframe();
+
+private:
+    void begin_block();
+    void op(std::uint8_t code);
+    void position(int y, int x, int advance);
+    void color(std::uint8_t code, Rgb value);
+    void encode_image(const std::uint32_t* rgba, bool full);
+
+    RenderBackend& inner_;
+    std::uint32_t surface_;
+    MemoryBackend shadow_;
+    std::vector<std::uint8_t> ops_;
+
+    int place_y_ = 0;
+    int place_x_ = 0;
+    unsigned int place_rows_ = 0;
+    unsigned int place_cols_ = 0;
+
+    // The bitmap currently shown, for row deltas and snapshots.
+    std::vector<std::uint32_t> image_;
+    int image_y_ = 0;
+    int image_x_ = 0;
+    int image_rows_ = 0;
+    int image_cols_ = 0;
+    int image_width_ = 0;
+    int image_height_ = 0;
+
+    // Delta state, reset at the start of every block.
+    int cursor_y_ = 0;
+    int cursor_x_ = 0;
+    Rgb last_color_{0, 0, 0};
+    Rgb last_background_{0, 0, 0};
+};
+
+class CaptureWriter {
+public:
+    // Throws std::runtime_error when the file cannot be created.
+    explicit CaptureWriter(const std::string& path);
+    // Writes the index and footer.
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    // Appends one frame from the surfaces' pending ops; frames where nothing
+    // changed are skipped unless a keyframe is due.
+    void write_frame(std::uint64_t time_us, const std::vector<RecordingBackend*>& surfaces);
+
+    std::uint64_t frames() const { return index_.size(); }
+
+private:
+    struct IndexEntry {
+        std::uint64_t offset;
+        std::uint64_t time_us;
+        bool keyframe;
+    };
+
+    std::ofstream file_;
+    std::uint64_t offset_ = 0;
+    std::vector<IndexEntry> index_;
+    std::uint64_t last_keyframe_us_ = 0;
+    std::vector<std::uint8_t> block_;
+    std::vector<std::uint8_t> payload_;
+    std::vector<std::uint8_t> record_;
+};
+
+// Receives decoded frames during playback.
+class CaptureTarget {
+public:
+    virtual ~CaptureTarget() = default;
+
+    // Moves and resizes a surface, creating it on first use; rows or cols of
+    // zero hide it.
+    virtual void place(std::uint32_t surface, int y, int x, unsigned int rows, unsigned int cols) = 0;
+    virtual RenderBackend& surface(std::uint32_t surface) = 0;
+};
+
+class CaptureReader {
+public:
+    // Throws std::runtime_error when the file is missing or not a capture.
+    // Files without an index (e.g. from a crashed session) are scanned.
+    explicit CaptureReader(const std::string& path);
+
+    std::size_t frame_count() const { return index_.size(); }
+    std::uint64_t time_us(std::size_t frame) const { return index_[frame].time_us; }
+    // Last frame at or before `time_us` (0 when the capture starts later).
+    std::size_t frame_at(std::uint64_t time_us) const;
+    // Nearest keyframe at or before `frame`.
+    std::size_t keyframe_before(std::size_t frame) const;
+
+    // Decodes one frame onto `target`. Frames must be applied in order,
+    // starting from a keyframe.
+    void apply(std::size_t frame, CaptureTarget& target);
+
+private:
+    struct IndexEntry {
+        std::uint64_t offset;
+        std::uint64_t time_us;
+        bool keyframe;
+    };
+
+    bool read_index(std::uint64_t file_size);
+    void scan_frames(std::uint64_t file_size);
+    void decode_block(const std::uint8_t* data, std::size_t size, std::uint32_t surface, CaptureTarget& target);
+
+    std::ifstream file_;
+    std::vector<IndexEntry> index_;
+    std::vector<std::uint8_t> payload_;
+    std::vector<SubCell> cells_;
+    std::string text_;
+    // Last bitmap per surface, patched by row deltas, and the cell rows the
+    // deltas of the current op touched.
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> images_;
+    std::vector<std::uint8_t> image_dirty_;
+};
+
+} // namespace who
@@ -6,6 +6,7 @@
 #include <sstream>
 #include <string_view>
 #include <unordered_map>
+#include <utility>
 
 namespace who {
 namespace {
@@ -293,6 +294,72 @@ void assign_string(const RawConfig& raw, const std::string& key, std::string& ta
     target = value;
 }
 
+// Collects `[panes.<name>]` sections in the order they appear in the file.
+void assign_panes(const RawConfig& raw, VisualConfig& visual, std::vector<std::string>& warnings) {
+    const std::string prefix = "panes.";
+    std::vector<std::pair<int, std::string>> names;
+    for (const auto& [key, scalar] : raw.scalars) {
+        if (key.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        const std::size_t dot = key.find('.', prefix.size());
+        if (dot == std::string::npos) {
+            continue;
+        }
+        const std::string name = key.substr(prefix.size(), dot - prefix.size());
+        const auto it = std::find_if(names.begin(), names.end(), [&](const auto& entry) { return entry.second == name; });
+        if (it == names.end()) {
+            names.emplace_back(scalar.line, name);
+        } else {
+            it->first = std::min(it->first, scalar.line);
+        }
+    }
+    std::sort(names.begin(), names.end());
+
+    for (const auto& [line, name] : names) {
+        const std::string section = prefix + name + ".";
+        PaneConfig pane;
+        pane.name = name;
+        pane.mode = visual.default_mode;
+        pane.palette = visual.default_palette;
+        pane.blitter = visual.default_blitter;
+        pane.rows = visual.grid.rows;
+        pane.cols = visual.grid.cols;
+        pane.sensitivity = visual.sensitivity.value;
+
+        std::string kind;
+        assign_string(raw, section + "kind", kind);
+        if (kind == "metrics") {
+            pane.metrics = true;
+        } else if (!kind.empty() && kind != "grid") {
+            std::ostringstream oss;
+            oss << "Unknown pane kind '" << kind << "' for pane '" << name << "' on line " << line;
+            warnings.push_back(oss.str());
+        }
+        std::string mode_value;
+        assign_string(raw, section + "mode", mode_value);
+        if (!mode_value.empty()) {
+            pane.mode = visualization_mode_from_string(mode_value, pane.mode);
+        }
+        std::string palette_value;
+        assign_string(raw, section + "palette", palette_value);
+        if (!palette_value.empty()) {
+            pane.palette = color_palette_from_string(palette_value, pane.palette);
+        }
+        std::string blitter_value;
+        assign_string(raw, section + "blitter", blitter_value);
+        if (!blitter_value.empty()) {
+            pane.blitter = grid_blitter_from_string(blitter_value, pane.blitter);
+        }
+        assign_scalar(raw, section + "rows", pane.rows, parse_int32, warnings);
+        assign_scalar(raw, section + "cols", pane.cols, parse_int32, warnings);
+        assign_scalar(raw, section + "sensitivity", pane.sensitivity, parse_float32, warnings);
+        assign_scalar(raw, section + "frame_divisor", pane.frame_divisor, parse_int32, warnings);
+        assign_scalar(raw, section + "weight", pane.weight, parse_double, warnings);
+        visual.panes.push_back(pane);
+    }
+}
+
 } // namespace
 
 ConfigLoadResult load_app_config(const std::string& path) {
@@ -350,6 +417,16 @@ ConfigLoadResult load_app_config(const std::string& path) {
                   result.config.audio.file.gain,
                   parse_float32,
                   result.warnings);
+    std::string pacing_value;
+    assign_string(raw, "audio.file.pacing", pacing_value);
+    if (!pacing_value.empty()) {
+        result.config.audio.file.pacing = file_pacing_from_string(pacing_value, result.config.audio.file.pacing);
+    }
+    assign_scalar(raw,
+                  "audio.file.decode_ahead",
+                  result.config.audio.file.decode_ahead,
+                  parse_double,
+                  result.warnings);
     assign_scalar(raw,
                   "audio.prefer_file",
                   result.config.audio.prefer_file,
@@ -359,7 +436,39 @@ ConfigLoadResult load_app_config(const std::string& path) {
     assign_scalar(raw, "dsp.fft_size", result.config.dsp.fft_size, parse_size, result.warnings);
     assign_scalar(raw, "dsp.hop_size", result.config.dsp.hop_size, parse_size, result.warnings);
     assign_scalar(raw, "dsp.bands", result.config.dsp.bands, parse_size, result.warnings);
-    assign_string(raw, "dsp.window", result.config.dsp.window);
+    std::string transform_value;
+    assign_string(raw, "dsp.transform", transform_value);
+    if (!transform_value.empty()) {
+        result.config.dsp.transform = fft_transform_from_string(transform_value, result.config.dsp.transform);
+    }
+    std::string band_scale_value;
+    assign_string(raw, "dsp.band_scale", band_scale_value);
+    if (!band_scale_value.empty()) {
+        result.config.dsp.band_scale = band_scale_from_string(band_scale_value, result.config.dsp.band_scale);
+    }
+    assign_scalar(raw, "dsp.min_frequency", result.config.dsp.min_frequency, parse_float32, result.warnings);
+    assign_scalar(raw, "dsp.max_frequency", result.config.dsp.max_frequency, parse_float32, result.warnings);
+    const auto resolutions_it = raw.arrays.find("dsp.resolutions");
+    if (resolutions_it != raw.arrays.end()) {
+        result.config.dsp.resolutions.clear();
+        for (const std::string& value : resolutions_it->second.values) {
+            std::size_t size = 0;
+            if (parse_size(value, size) && size >= 2 && (size & (size - 1)) == 0) {
+                result.config.dsp.resolutions.push_back(size);
+            } else {
+                std::ostringstream oss;
+                oss << "Ignoring FFT resolution '" << value << "' on line " << resolutions_it->second.line
+                    << " (must be a power of two)";
+                result.warnings.push_back(oss.str());
+            }
+        }
+    }
+    std::string window_value;
+    assign_string(raw, "dsp.window", window_value);
+    if (!window_value.empty()) {
+        result.config.dsp.window = window_type_from_string(window_value, result.config.dsp.window);
+    }
+    assign_scalar(raw, "dsp.kaiser_beta", result.config.dsp.kaiser_beta, parse_float32, result.warnings);
     assign_scalar(raw,
                   "dsp.smoothing_attack",
                   result.config.dsp.smoothing_attack,
@@ -376,6 +485,12 @@ ConfigLoadResult load_app_config(const std::string& path) {
                   parse_float32,
                   result.warnings);
     assign_scalar(raw, "dsp.enable_flux", result.config.dsp.enable_flux, parse_bool, result.warnings);
+    std::string backlog_value;
+    assign_string(raw, "dsp.backlog_policy", backlog_value);
+    if (!backlog_value.empty()) {
+        result.config.dsp.backlog = backlog_policy_from_string(backlog_value, result.config.dsp.backlog);
+    }
+    assign_scalar(raw, "dsp.max_catchup_hops", result.config.dsp.max_catchup_hops, parse_size, result.warnings);
 
     assign_scalar(raw, "visual.grid.rows", result.config.visual.grid.rows, parse_int32, result.warnings);
     assign_scalar(raw, "visual.grid.cols", result.config.visual.grid.cols, parse_int32, result.warnings);
@@ -413,12 +528,21 @@ ConfigLoadResult load_app_config(const std::string& path) {
     if (!palette_value.empty()) {
         result.config.visual.default_palette = color_palette_from_string(palette_value, result.config.visual.default_palette);
     }
+    std::string blitter_value;
+    assign_string(raw, "visual.blitter", blitter_value);
+    if (!blitter_value.empty()) {
+        result.config.visual.default_blitter = grid_blitter_from_string(blitter_value, result.config.visual.default_blitter);
+    }
     assign_scalar(raw, "visual.target_fps", result.config.visual.target_fps, parse_double, result.warnings);
+    assign_scalar(raw, "visual.min_fps", result.config.visual.min_fps, parse_double, result.warnings);
+    assign_scalar(raw, "visual.adaptive_fps", result.config.visual.adaptive_fps, parse_bool, result.warnings);
+    assign_scalar(raw, "visual.render_threads", result.config.visual.render_threads, parse_int32, result.warnings);
 
     assign_scalar(raw, "runtime.show_metrics", result.config.runtime.show_metrics, parse_bool, result.warnings);
     assign_scalar(raw, "runtime.allow_resize", result.config.runtime.allow_resize, parse_bool, result.warnings);
     assign_scalar(raw, "runtime.beat_flash", result.config.runtime.beat_flash, parse_bool, result.warnings);
     assign_scalar(raw, "runtime.show_overlay_metrics", result.config.runtime.show_overlay_metrics, parse_bool, result.warnings);
+    assign_scalar(raw, "runtime.idle_after", result.config.runtime.idle_after, parse_double, result.warnings);
 
     assign_string(raw, "plugins.directory", result.config.plugins.directory);
     const auto array_it = raw.arrays.find("plugins.autoload");
@@ -443,9 +567,26 @@ ConfigLoadResult load_app_config(const std::string& path) {
     if (result.config.audio.file.gain <= 0.0f) {
         result.config.audio.file.gain = 1.0f;
     }
+    if (!(result.config.audio.file.decode_ahead > 0.0)) {
+        result.config.audio.file.decode_ahead = 0.5;
+    }
+    result.config.audio.file.decode_ahead = std::clamp(result.config.audio.file.decode_ahead, 0.05, 10.0);
+    if (!result.config.dsp.resolutions.empty()) {
+        result.config.dsp.fft_size =
+            *std::max_element(result.config.dsp.resolutions.begin(), result.config.dsp.resolutions.end());
+    }
     if (result.config.dsp.hop_size == 0) {
         result.config.dsp.hop_size = std::max<std::size_t>(1, result.config.dsp.fft_size / 4);
     }
+    if (result.config.dsp.min_frequency <= 0.0f) {
+        result.config.dsp.min_frequency = 20.0f;
+    }
+    if (result.config.dsp.max_frequency < 0.0f) {
+        result.config.dsp.max_frequency = 0.0f;
+    }
+    if (result.config.dsp.max_catchup_hops == 0) {
+        result.config.dsp.max_catchup_hops = 1;
+    }
     if (result.config.visual.grid.min_dim < 1) {
         result.config.visual.grid.min_dim = 1;
     }
@@ -467,6 +608,24 @@ ConfigLoadResult load_app_config(const std::string& path) {
     if (result.config.visual.target_fps <= 0.0) {
         result.config.visual.target_fps = 60.0;
     }
+    result.config.visual.min_fps = std::clamp(result.config.visual.min_fps, 1.0, result.config.visual.target_fps);
+    if (result.config.visual.render_threads < 0) {
+        result.config.visual.render_threads = 0;
+    }
+    assign_panes(raw, result.config.visual, result.warnings);
+    for (PaneConfig& pane : result.config.visual.panes) {
+        pane.rows = std::clamp(pane.rows, result.config.visual.grid.min_dim, result.config.visual.grid.max_dim);
+        pane.cols = std::clamp(pane.cols, result.config.visual.grid.min_dim, result.config.visual.grid.max_dim);
+        pane.sensitivity = std::max(result.config.visual.sensitivity.min_value,
+                                    std::min(pane.sensitivity, result.config.visual.sensitivity.max_value));
+        pane.frame_divisor = std::max(1, pane.frame_divisor);
+        if (pane.weight <= 0.0) {
+            pane.weight = 1.0;
+        }
+    }
+    if (result.config.runtime.idle_after < 0.0) {
+        result.config.runtime.idle_after = 0.0;
+    }
     if (result.config.plugins.autoload.empty()) {
         result.config.plugins.autoload.push_back("beat-flash-debug");
     }
@@ -516,5 +675,124 @@ ColorPalette color_palette_from_string(const std::string& value, ColorPalette fa
     return fallback;
 }
 
-} // namespace who
+GridBlitter grid_blitter_from_string(const std::string& value, GridBlitter fallback) {
+    std::string lower(value);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == "solid") {
+        return GridBlitter::Solid;
+    }
+    if (lower == "half" || lower == "halfblock" || lower == "half-block" || lower == "half_block") {
+        return GridBlitter::HalfBlock;
+    }
+    if (lower == "quadrant" || lower == "quad") {
+        return GridBlitter::Quadrant;
+    }
+    if (lower == "sextant") {
+        return GridBlitter::Sextant;
+    }
+    if (lower == "braille") {
+        return GridBlitter::Braille;
+    }
+    if (lower == "pixel" || lower == "sixel" || lower == "kitty") {
+        return GridBlitter::Pixel;
+    }
+    return fallback;
+}
+
+FftTransform fft_transform_from_string(const std::string& value, FftTransform fallback) {
+    std::string lower(value);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == "real" || lower == "rfft") {
+        return FftTransform::Real;
+    }
+    if (lower == "complex" || lower == "cfft") {
+        return FftTransform::Complex;
+    }
+    return fallback;
+}
+
+BandScale band_scale_from_string(const std::string& value, BandScale fallback) {
+    std::string lower(value);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == "log" || lower == "constant-q" || lower == "constant_q" || lower == "cq") {
+        return BandScale::Log;
+    }
+    if (lower == "mel") {
+        return BandScale::Mel;
+    }
+    if (lower == "bark") {
+        return BandScale::Bark;
+    }
+    if (lower == "erb") {
+        return BandScale::Erb;
+    }
+    return fallback;
+}
+
+WindowType window_type_from_string(const std::string& value, WindowType fallback) {
+    std::string lower(value);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == "hann" || lower == "hanning") {
+        return WindowType::Hann;
+    }
+    if (lower == "hamming") {
+        return WindowType::Hamming;
+    }
+    if (lower == "blackman-harris" || lower == "blackman_harris" || lower == "blackmanharris") {
+        return WindowType::BlackmanHarris;
+    }
+    if (lower == "flat-top" || lower == "flat_top" || lower == "flattop") {
+        return WindowType::FlatTop;
+    }
+    if (lower == "kaiser") {
+        return WindowType::Kaiser;
+    }
+    return fallback;
+}
+
+BacklogPolicy backlog_policy_from_string(const std::string& value, BacklogPolicy fallback) {
+    std::string lower(value);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == "all") {
+        return BacklogPolicy::All;
+    }
+    if (lower == "latest" || lower == "skip") {
+        return BacklogPolicy::Latest;
+    }
+    return fallback;
+}
 
+FilePacing file_pacing_from_string(const std::string& value, FilePacing fallback) {
+    std::string lower(value);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == "realtime" || lower == "real-time") {
+        return FilePacing::Realtime;
+    }
+    if (lower == "fast") {
+        return FilePacing::Fast;
+    }
+    return fallback;
+}
+
+DspOptions make_dsp_options(const DspConfig& config) {
+    DspOptions options;
+    options.fft_size = config.fft_size;
+    options.hop_size = config.hop_size;
+    options.bands = config.bands;
+    options.transform = config.transform;
+    options.layout.scale = config.band_scale;
+    options.layout.min_frequency = config.min_frequency;
+    options.layout.max_frequency = config.max_frequency;
+    options.resolutions = config.resolutions;
+    options.window = config.window;
+    options.kaiser_beta = config.kaiser_beta;
+    options.smoothing_attack = config.smoothing_attack;
+    options.smoothing_release = config.smoothing_release;
+    options.beat_sensitivity = config.beat_sensitivity;
+    options.enable_flux = config.enable_flux;
+    options.backlog = config.backlog;
+    options.max_catchup_hops = config.max_catchup_hops;
+    return options;
+}
+
+} // namespace who
@@ -5,6 +5,8 @@
 #include <string>
 #include <vector>
 
+#include "audio_engine.h"
+#include "dsp.h"
 #include "renderer.h"
 
 namespace who {
@@ -24,6 +26,8 @@ struct AudioFileConfig {
     std::string path;
     std::uint32_t channels = 1;
     float gain = 1.0f;
+    FilePacing pacing = FilePacing::Realtime;
+    double decode_ahead = 0.5;
 };
 
 struct AudioConfig {
@@ -36,11 +40,19 @@ struct DspConfig {
     std::size_t fft_size = 1024;
     std::size_t hop_size = 256;
     std::size_t bands = 32;
-    std::string window = "hann";
+    FftTransform transform = FftTransform::Real;
+    BandScale band_scale = BandScale::Log;
+    float min_frequency = 20.0f;
+    float max_frequency = 0.0f;
+    std::vector<std::size_t> resolutions;
+    WindowType window = WindowType::Hann;
+    float kaiser_beta = 8.6f;
     float smoothing_attack = 0.2f;
     float smoothing_release = 0.05f;
     float beat_sensitivity = 1.0f;
     bool enable_flux = true;
+    BacklogPolicy backlog = BacklogPolicy::All;
+    std::size_t max_catchup_hops = 4;
 };
 
 struct GridConfig {
@@ -57,12 +69,32 @@ struct SensitivityConfig {
     float step = 0.1f;
 };
 
+// One `[panes.<name>]` section; unset keys fall back to the visual defaults.
+struct PaneConfig {
+    std::string name;
+    bool metrics = false;
+    VisualizationMode mode = VisualizationMode::Bands;
+    ColorPalette palette = ColorPalette::Rainbow;
+    GridBlitter blitter = GridBlitter::Solid;
+    int rows = 16;
+    int cols = 16;
+    float sensitivity = 1.0f;
+    int frame_divisor = 1;
+    double weight = 1.0;
+};
+
 struct VisualConfig {
     GridConfig grid;
     SensitivityConfig sensitivity;
     VisualizationMode default_mode = VisualizationMode::Bands;
     ColorPalette default_palette = ColorPalette::Rainbow;
+    GridBlitter default_blitter = GridBlitter::Solid;
     double target_fps = 60.0;
+    double min_fps = 15.0;
+    bool adaptive_fps = true;
+    int render_threads = 0;
+    // In file order; empty means a single grid pane covering the screen.
+    std::vector<PaneConfig> panes;
 };
 
 struct RuntimeConfig {
@@ -70,6 +102,7 @@ struct RuntimeConfig {
     bool allow_resize = true;
     bool beat_flash = true;
     bool show_overlay_metrics = false; // New config option, default to false
+    double idle_after = 5.0;
 };
 
 struct PluginConfig {
@@ -98,6 +131,13 @@ VisualizationMode visualization_mode_from_string(const std::string& value,
                                                   VisualizationMode fallback = VisualizationMode::Bands);
 ColorPalette color_palette_from_string(const std::string& value,
                                        ColorPalette fallback = ColorPalette::Rainbow);
+GridBlitter grid_blitter_from_string(const std::string& value, GridBlitter fallback = GridBlitter::Solid);
+FftTransform fft_transform_from_string(const std::string& value, FftTransform fallback = FftTransform::Real);
+BandScale band_scale_from_string(const std::string& value, BandScale fallback = BandScale::Log);
+WindowType window_type_from_string(const std::string& value, WindowType fallback = WindowType::Hann);
+BacklogPolicy backlog_policy_from_string(const std::string& value, BacklogPolicy fallback = BacklogPolicy::All);
+FilePacing file_pacing_from_string(const std::string& value, FilePacing fallback = FilePacing::Realtime);
+DspOptions make_dsp_options(const DspConfig& config);
 
 } // namespace who
 
@@ -1,46 +1,137 @@
 #include "dsp.h"
 
+#include "simd_kernels.h"
+
 #include <algorithm>
 #include <cmath>
-#include <cstring>
+#include <initializer_list>
 #include <stdexcept>
 #include <vector>
 
-extern "C" {
-#include <kiss_fft.h>
-}
-
 namespace who {
 
 namespace {
-constexpr float kMinDisplayFrequency = 20.0f;
 constexpr float kPi = 3.14159265358979323846f;
+
+std::vector<std::size_t> resolution_sizes(std::size_t fft_size, const std::vector<std::size_t>& resolutions) {
+    std::vector<std::size_t> sizes = resolutions.empty() ? std::vector<std::size_t>{fft_size} : resolutions;
+    for (std::size_t size : sizes) {
+        if (size < 2 || (size & (size - 1)) != 0) {
+            throw std::invalid_argument("FFT size must be a power of two greater than 1");
+        }
+    }
+    std::sort(sizes.begin(), sizes.end());
+    sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+    return sizes;
+}
+
+double bessel_i0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    const double half_x = x * 0.5;
+    for (int k = 1; k < 64; ++k) {
+        term *= (half_x / static_cast<double>(k)) * (half_x / static_cast<double>(k));
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+double cosine_sum(double phase, std::initializer_list<double> coefficients) {
+    double value = 0.0;
+    double sign = 1.0;
+    int harmonic = 0;
+    for (double coefficient : coefficients) {
+        value += sign * coefficient * std::cos(phase * harmonic);
+        sign = -sign;
+        ++harmonic;
+    }
+    return value;
+}
+
+std::vector<float> make_hann_window(std::size_t size) {
+    std::vector<float> window(size, 0.0f);
+    const float denominator = static_cast<float>(size - 1);
+    for (std::size_t i = 0; i < size; ++i) {
+        const float phase = (denominator == 0.0f) ? 0.0f : (2.0f * kPi * static_cast<float>(i)) / denominator;
+        window[i] = 0.5f - 0.5f * std::cos(phase);
+    }
+    return window;
+}
+
+// Builds the analysis window once. Non-Hann windows are rescaled to Hann's
+// coherent gain so switching windows does not shift overall band levels.
+std::vector<float> make_window(WindowType type, std::size_t size, float kaiser_beta) {
+    std::vector<float> hann = make_hann_window(size);
+    if (type == WindowType::Hann) {
+        return hann;
+    }
+
+    std::vector<double> values(size, 1.0);
+    const double denominator = static_cast<double>(size > 1 ? size - 1 : 1);
+    const double i0_beta = bessel_i0(kaiser_beta);
+    for (std::size_t i = 0; i < size; ++i) {
+        const double phase = 2.0 * static_cast<double>(kPi) * static_cast<double>(i) / denominator;
+        switch (type) {
+        case WindowType::Hamming:
+            values[i] = cosine_sum(phase, {0.54, 0.46});
+            break;
+        case WindowType::BlackmanHarris:
+            values[i] = cosine_sum(phase, {0.35875, 0.48829, 0.14128, 0.01168});
+            break;
+        case WindowType::FlatTop:
+            values[i] = cosine_sum(phase, {0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368});
+            break;
+        case WindowType::Kaiser: {
+            const double ratio = 2.0 * static_cast<double>(i) / denominator - 1.0;
+            values[i] = bessel_i0(kaiser_beta * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / i0_beta;
+            break;
+        }
+        case WindowType::Hann:
+            break;
+        }
+    }
+
+    double hann_sum = 0.0;
+    double window_sum = 0.0;
+    for (std::size_t i = 0; i < size; ++i) {
+        hann_sum += hann[i];
+        window_sum += values[i];
+    }
+    const double gain = (window_sum > 0.0) ? hann_sum / window_sum : 1.0;
+    std::vector<float> window(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        window[i] = static_cast<float>(values[i] * gain);
+    }
+    return window;
+}
+
 } // namespace
 
-DspEngine::DspEngine(std::uint32_t sample_rate,
-                     std::uint32_t channels,
-                     std::size_t fft_size,
-                     std::size_t hop_size,
-                     std::size_t bands)
+DspEngine::DspEngine(std::uint32_t sample_rate, std::uint32_t channels, const DspOptions& options)
     : sample_rate_(sample_rate),
       channels_(channels),
-      fft_size_(fft_size),
-      hop_size_(hop_size),
-      window_(fft_size_, 0.0f),
-      frame_buffer_(fft_size_, 0.0f),
-      band_energies_(bands, 0.0f),
-      band_bin_ranges_(bands),
-      prev_magnitudes_(bands, 0.0f),
-      fft_cfg_(nullptr),
-      fft_in_(fft_size_),
-      fft_out_(fft_size_),
-      smoothing_attack_(0.35f),
-      smoothing_release_(0.08f),
+      fft_size_(0),
+      hop_size_(options.hop_size),
+      history_(resolution_sizes(options.fft_size, options.resolutions).back()),
+      mono_scratch_(hop_size_, 0.0f),
+      hop_fill_(0),
+      backlog_(options.backlog),
+      max_catchup_hops_(std::max<std::size_t>(1, options.max_catchup_hops)),
+      catchup_steps_(0),
+      frames_processed_(0),
+      band_energies_(options.bands, 0.0f),
+      band_power_(options.bands, 0.0f),
+      prev_magnitudes_(options.enable_flux ? options.bands : 0, 0.0f),
+      smoothing_attack_(std::clamp(options.smoothing_attack, 0.0f, 1.0f)),
+      smoothing_release_(std::clamp(options.smoothing_release, 0.0f, 1.0f)),
+      beat_threshold_(1.35f / std::max(options.beat_sensitivity, 0.05f)),
+      enable_flux_(options.enable_flux),
       flux_average_(0.0f),
       beat_strength_(0.0f) {
-    if (fft_size_ < 2 || (fft_size_ & (fft_size_ - 1)) != 0) {
-        throw std::invalid_argument("FFT size must be a power of two greater than 1");
-    }
+    fft_size_ = history_.size();
     if (hop_size_ == 0 || hop_size_ > fft_size_) {
         throw std::invalid_argument("Invalid hop size");
     }
@@ -48,25 +139,40 @@ DspEngine::DspEngine(std::uint32_t sample_rate,
         throw std::invalid_argument("Channels must be non-zero");
     }
 
-    const float denominator = static_cast<float>(fft_size_ - 1);
-    for (std::size_t i = 0; i < fft_size_; ++i) {
-        const float phase = (denominator == 0.0f) ? 0.0f : (2.0f * kPi * static_cast<float>(i)) / denominator;
-        const float w = 0.5f - 0.5f * std::cos(phase);
-        window_[i] = w;
+    for (std::size_t size : resolution_sizes(options.fft_size, options.resolutions)) {
+        Resolution resolution;
+        resolution.size = size;
+        resolution.fft = std::make_unique<FftPlan>(size, options.transform);
+        resolution.window = make_window(options.window, size, options.kaiser_beta);
+        resolution.input.assign(size, 0.0f);
+        resolution.spectrum.resize(resolution.fft->bins());
+        resolution.bin_power.assign(resolution.fft->bins(), 0.0f);
+        resolution.filterbank = Filterbank(options.bands, size, sample_rate_, options.layout);
+        resolutions_.push_back(std::move(resolution));
     }
 
-    fft_cfg_ = kiss_fft_alloc(static_cast<int>(fft_size_), 0, nullptr, nullptr);
-    if (!fft_cfg_) {
-        throw std::runtime_error("Failed to allocate FFT config");
-    }
-
-    compute_band_ranges();
+    assign_bands();
 }
 
-DspEngine::~DspEngine() {
-    if (fft_cfg_) {
-        kiss_fft_free(fft_cfg_);
-        fft_cfg_ = nullptr;
+void DspEngine::assign_bands() {
+    // Judge every band by its width under the longest transform, then hand it
+    // to the shortest transform that still spreads it over a few bins: bass
+    // keeps the long window's resolution, treble gets the short one's latency.
+    constexpr float kMinBinsPerBand = 3.0f;
+    const Resolution& longest = resolutions_.back();
+    const float longest_bin_hz = static_cast<float>(sample_rate_) / static_cast<float>(longest.size);
+    for (std::size_t band = 0; band < band_power_.size(); ++band) {
+        const float width_hz =
+            static_cast<float>(longest.filterbank.last_bin(band) - longest.filterbank.first_bin(band) + 1) * longest_bin_hz;
+        Resolution* chosen = &resolutions_.back();
+        for (Resolution& resolution : resolutions_) {
+            const float bin_hz = static_cast<float>(sample_rate_) / static_cast<float>(resolution.size);
+            if (width_hz >= kMinBinsPerBand * bin_hz) {
+                chosen = &resolution;
+                break;
+            }
+        }
+        chosen->bands.push_back(static_cast<std::uint32_t>(band));
     }
 }
 
@@ -76,101 +182,114 @@ void DspEngine::push_samples(const float* interleaved_samples, std::size_t count
     }
 
     const std::size_t frames = count / channels_;
-    for (std::size_t i = 0; i < frames; ++i) {
-        double sum = 0.0;
-        for (std::size_t ch = 0; ch < channels_; ++ch) {
-            sum += interleaved_samples[i * channels_ + ch];
+    std::size_t frame = 0;
+    std::size_t hops_to_skip = 0;
+
+    if (backlog_ == BacklogPolicy::Latest) {
+        const std::size_t pending_hops = (hop_fill_ + frames) / hop_size_;
+        if (pending_hops > max_catchup_hops_) {
+            const std::size_t skipped = pending_hops - max_catchup_hops_;
+            // Input offset where the first analysed hop completes; anything
+            // older than one FFT window before it never reaches an analysed
+            // frame, so it is not even downmixed.
+            const std::size_t first_end = (skipped + 1) * hop_size_ - hop_fill_;
+            const std::size_t start = first_end > fft_size_ ? first_end - fft_size_ : 0;
+            const std::size_t hops_before_start = (hop_fill_ + start) / hop_size_;
+            hop_fill_ = (hop_fill_ + start) % hop_size_;
+            frame = start;
+            hops_to_skip = skipped - hops_before_start;
+            catchup_steps_ += skipped;
         }
-        mono_fifo_.push_back(static_cast<float>(sum / static_cast<double>(channels_)));
     }
 
-    while (mono_fifo_.size() >= hop_size_) {
-        std::memmove(frame_buffer_.data(), frame_buffer_.data() + hop_size_,
-                     (fft_size_ - hop_size_) * sizeof(float));
+    while (frame < frames) {
+        const std::size_t chunk = std::min(frames - frame, hop_size_ - hop_fill_);
+        kernels::downmix(interleaved_samples + frame * channels_, chunk, channels_, mono_scratch_.data());
+        history_.push(mono_scratch_.data(), chunk);
+        frame += chunk;
+        hop_fill_ += chunk;
 
-        for (std::size_t i = 0; i < hop_size_; ++i) {
-            frame_buffer_[fft_size_ - hop_size_ + i] = mono_fifo_.front();
-            mono_fifo_.pop_front();
+        if (hop_fill_ == hop_size_) {
+            hop_fill_ = 0;
+            if (hops_to_skip > 0) {
+                --hops_to_skip;
+                continue;
+            }
+            process_frame(history_.view());
         }
-
-        process_frame();
     }
 }
 
-void DspEngine::compute_band_ranges() {
-    const std::size_t bands = band_energies_.size();
-    if (bands == 0) {
-        return;
+void DspEngine::process_frame(const float* frame) {
+    ++frames_processed_;
+    for (Resolution& resolution : resolutions_) {
+        if (resolution.bands.empty()) {
+            continue;
+        }
+        const float norm = 1.0f / static_cast<float>(resolution.size);
+        const float* newest = frame + (fft_size_ - resolution.size);
+        kernels::apply_window(newest, resolution.window.data(), resolution.input.data(), resolution.size);
+        resolution.fft->forward(resolution.input.data(), resolution.spectrum.data());
+        kernels::spectrum_power(reinterpret_cast<const float*>(resolution.spectrum.data()),
+                                norm,
+                                resolution.bin_power.data(),
+                                resolution.bin_power.size());
+        // A band spans size / fft_size_ times as many bins in a shorter
+        // transform, each holding proportionally more power; rescale so band
+        // levels match whichever resolution produced them.
+        const float level = static_cast<float>(resolution.size) / static_cast<float>(fft_size_);
+        for (std::uint32_t band : resolution.bands) {
+            band_power_[band] = resolution.filterbank.apply_band(band, resolution.bin_power.data()) * level;
+        }
     }
 
-    const float nyquist = std::max(static_cast<float>(sample_rate_) * 0.5f, kMinDisplayFrequency * 1.1f);
-    const float bin_width = static_cast<float>(sample_rate_) / static_cast<float>(fft_size_);
-    const float min_freq = std::max(kMinDisplayFrequency, bin_width);
-    const float log_min = std::log(min_freq);
-    const float log_max = std::log(nyquist);
-
-    for (std::size_t i = 0; i < bands; ++i) {
-        const float t0 = static_cast<float>(i) / static_cast<float>(bands);
-        const float t1 = static_cast<float>(i + 1) / static_cast<float>(bands);
-        const float f0 = (i == 0) ? 0.0f : std::exp(log_min + (log_max - log_min) * t0);
-        const float f1 = std::exp(log_min + (log_max - log_min) * t1);
-
-        std::size_t bin0 = static_cast<std::size_t>(std::floor(f0 / bin_width));
-        std::size_t bin1 = static_cast<std::size_t>(std::ceil(f1 / bin_width));
-
-        bin0 = std::min(bin0, fft_size_ / 2);
-        bin1 = std::clamp(bin1, bin0 + 1, fft_size_ / 2 + 1);
-
-        band_bin_ranges_[i] = {bin0, bin1};
+    if (enable_flux_) {
+        update_bands<true>();
+    } else {
+        update_bands<false>();
     }
 }
 
-void DspEngine::process_frame() {
-    if (!fft_cfg_) {
-        return;
-    }
-
-    const float norm = 1.0f / static_cast<float>(fft_size_);
-
-    for (std::size_t i = 0; i < fft_size_; ++i) {
-        const float windowed = frame_buffer_[i] * window_[i];
-        fft_in_[i].r = windowed;
-        fft_in_[i].i = 0.0f;
+template <bool WithFlux>
+void DspEngine::update_bands() {
+    // Hops skipped by the Latest backlog policy are folded into this update as
+    // repeats of the current frame, so every EMA keeps its time constant.
+    float attack = smoothing_attack_;
+    float release = smoothing_release_;
+    float flux_keep = 0.92f;
+    float beat_keep = 0.6f;
+    if (catchup_steps_ > 0) {
+        const float steps = static_cast<float>(catchup_steps_ + 1);
+        attack = 1.0f - std::pow(1.0f - smoothing_attack_, steps);
+        release = 1.0f - std::pow(1.0f - smoothing_release_, steps);
+        flux_keep = std::pow(flux_keep, steps);
+        beat_keep = std::pow(beat_keep, steps);
+        catchup_steps_ = 0;
     }
 
-    kiss_fft(fft_cfg_, fft_in_.data(), fft_out_.data());
-
     float flux = 0.0f;
-    for (std::size_t band = 0; band < band_bin_ranges_.size(); ++band) {
-        const auto [start_bin, end_bin] = band_bin_ranges_[band];
-        float energy = 0.0f;
-        for (std::size_t bin = start_bin; bin < end_bin && bin <= fft_size_ / 2; ++bin) {
-            const float real = fft_out_[bin].r * norm;
-            const float imag = fft_out_[bin].i * norm;
-            energy += real * real + imag * imag;
-        }
-        const std::size_t bin_count = (end_bin > start_bin) ? (end_bin - start_bin) : 1;
-        const float average_energy = energy / static_cast<float>(bin_count);
-        const float magnitude = std::sqrt(std::max(average_energy, 0.0f));
-        const float previous = (band < prev_magnitudes_.size()) ? prev_magnitudes_[band] : 0.0f;
-        if (band < prev_magnitudes_.size()) {
+    for (std::size_t band = 0; band < band_power_.size(); ++band) {
+        const float magnitude = std::sqrt(std::max(band_power_[band], 0.0f));
+        if constexpr (WithFlux) {
+            flux += std::max(0.0f, magnitude - prev_magnitudes_[band]);
             prev_magnitudes_[band] = magnitude;
         }
-        flux += std::max(0.0f, magnitude - previous);
         const float current = band_energies_[band];
         const float target = magnitude;
-        const float alpha = (target > current) ? smoothing_attack_ : smoothing_release_;
+        const float alpha = (target > current) ? attack : release;
         band_energies_[band] = current + (target - current) * alpha;
     }
 
-    flux_average_ = flux_average_ * 0.92f + flux * 0.08f;
-    const float baseline = std::max(flux_average_ * 1.35f, 1e-4f);
-    float beat_instant = 0.0f;
-    if (flux > baseline) {
-        beat_instant = std::min((flux - baseline) / baseline, 1.0f);
+    if constexpr (WithFlux) {
+        flux_average_ = flux_average_ * flux_keep + flux * (1.0f - flux_keep);
+        const float baseline = std::max(flux_average_ * beat_threshold_, 1e-4f);
+        float beat_instant = 0.0f;
+        if (flux > baseline) {
+            beat_instant = std::min((flux - baseline) / baseline, 1.0f);
+        }
+        beat_strength_ = std::max(beat_instant, beat_strength_ * beat_keep);
+        beat_strength_ = std::clamp(beat_strength_, 0.0f, 1.0f);
     }
-    beat_strength_ = std::max(beat_instant, beat_strength_ * 0.6f);
-    beat_strength_ = std::clamp(beat_strength_, 0.0f, 1.0f);
 }
 
 } // namespace who
@@ -2,57 +2,105 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <deque>
-#include <utility>
+#include <memory>
 #include <vector>
 
-extern "C" {
-#include <kiss_fft.h>
-}
+#include "fft.h"
+#include "filterbank.h"
+#include "sliding_window.h"
 
 namespace who {
 
+enum class WindowType {
+    Hann,
+    Hamming,
+    BlackmanHarris,
+    FlatTop,
+    Kaiser,
+};
+
+// How push_samples handles a backlog of more hops than max_catchup_hops.
+enum class BacklogPolicy {
+    All,    // Analyse every hop in order.
+    Latest, // Analyse only the newest hops; fast-forward state over the rest.
+};
+
+struct DspOptions {
+    std::size_t fft_size = 1024;
+    std::size_t hop_size = 512;
+    std::size_t bands = 16;
+    FftTransform transform = FftTransform::Real;
+    BandLayout layout;
+    // Optional list of power-of-two FFT sizes analysed on every hop; each band
+    // is then taken from the shortest transform that still resolves it. When
+    // empty, only fft_size is used.
+    std::vector<std::size_t> resolutions;
+    WindowType window = WindowType::Hann;
+    float kaiser_beta = 8.6f;
+    float smoothing_attack = 0.35f;
+    float smoothing_release = 0.08f;
+    // Scales the spectral-flux beat threshold; higher values fire more readily.
+    float beat_sensitivity = 1.0f;
+    // When false, spectral flux and beat tracking are skipped entirely.
+    bool enable_flux = true;
+    BacklogPolicy backlog = BacklogPolicy::All;
+    std::size_t max_catchup_hops = 4;
+};
+
 class DspEngine {
 public:
-    static constexpr std::size_t kDefaultFftSize = 1024;
-    static constexpr std::size_t kDefaultHopSize = kDefaultFftSize / 2;
-    static constexpr std::size_t kDefaultBands = 16;
-
-    DspEngine(std::uint32_t sample_rate,
-              std::uint32_t channels,
-              std::size_t fft_size = kDefaultFftSize,
-              std::size_t hop_size = kDefaultHopSize,
-              std::size_t bands = kDefaultBands);
-    ~DspEngine();
+    DspEngine(std::uint32_t sample_rate, std::uint32_t channels, const DspOptions& options = {});
 
     void push_samples(const float* interleaved_samples, std::size_t count);
 
     const std::vector<float>& band_energies() const { return band_energies_; }
     float beat_strength() const { return beat_strength_; }
+    std::uint32_t sample_rate() const { return sample_rate_; }
+    std::size_t hop_size() const { return hop_size_; }
+    // Number of hops analysed so far; changes whenever the outputs do.
+    std::uint64_t frames_processed() const { return frames_processed_; }
 
 private:
-    void compute_band_ranges();
-    void process_frame();
+    // One FFT size analysed per hop, reading the newest `size` samples of the
+    // shared history and producing the bands assigned to it.
+    struct Resolution {
+        std::size_t size = 0;
+        std::unique_ptr<FftPlan> fft;
+        std::vector<float> window;
+        std::vector<float> input;
+        std::vector<kiss_fft_cpx> spectrum;
+        std::vector<float> bin_power;
+        Filterbank filterbank;
+        std::vector<std::uint32_t> bands;
+    };
+
+    void assign_bands();
+    void process_frame(const float* frame);
+    template <bool WithFlux>
+    void update_bands();
 
     std::uint32_t sample_rate_;
     std::uint32_t channels_;
     std::size_t fft_size_;
     std::size_t hop_size_;
 
-    std::vector<float> window_;
-    std::vector<float> frame_buffer_;
-    std::deque<float> mono_fifo_;
+    std::vector<Resolution> resolutions_;
+    SlidingWindow history_;
+    std::vector<float> mono_scratch_;
+    std::size_t hop_fill_;
+    BacklogPolicy backlog_;
+    std::size_t max_catchup_hops_;
+    std::size_t catchup_steps_;
+    std::uint64_t frames_processed_;
 
     std::vector<float> band_energies_;
-    std::vector<std::pair<std::size_t, std::size_t>> band_bin_ranges_;
+    std::vector<float> band_power_;
     std::vector<float> prev_magnitudes_;
 
-    kiss_fft_cfg fft_cfg_;
-    std::vector<kiss_fft_cpx> fft_in_;
-    std::vector<kiss_fft_cpx> fft_out_;
-
     float smoothing_attack_;
     float smoothing_release_;
+    float beat_threshold_;
+    bool enable_flux_;
     float flux_average_;
     float beat_strength_;
 };
@@ -0,0 +1,176 @@
+#include "dsp_worker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace who {
+
+namespace {
+// Metric smoothing constants were tuned per 60 Hz render frame; the worker
+// converts them to time-based decays so its polling rate does not matter.
+constexpr double kMetricsReferenceRate = 60.0;
+constexpr std::chrono::microseconds kMinPollInterval{1000};
+constexpr std::chrono::microseconds kMaxPollInterval{10000};
+// While idle the worker ignores new-sample notifications and checks the level
+// this often, or every half ring if that is shorter so nothing is dropped.
+constexpr std::chrono::milliseconds kIdlePollInterval{250};
+// -60 dBFS; quieter input counts as silence for idling.
+constexpr float kSilencePeak = 0.001f;
+} // namespace
+
+float update_audio_metrics(AudioMetrics& metrics, const RingSpan<float>& samples, double elapsed_s) {
+    const double frames = elapsed_s * kMetricsReferenceRate;
+    const std::size_t count = samples.size();
+    float peak_value = 0.0f;
+    if (count > 0) {
+        double sum_squares = 0.0;
+        const auto accumulate = [&](const float* data, std::size_t size) {
+            for (std::size_t i = 0; i < size; ++i) {
+                const float sample = data[i];
+                sum_squares += static_cast<double>(sample) * static_cast<double>(sample);
+                peak_value = std::max(peak_value, std::abs(sample));
+            }
+        };
+        accumulate(samples.first, samples.first_size);
+        accumulate(samples.second, samples.second_size);
+        const float rms_instant = static_cast<float>(std::sqrt(sum_squares / static_cast<double>(count)));
+        const float keep = static_cast<float>(std::pow(0.9, frames));
+        metrics.rms = metrics.rms * keep + rms_instant * (1.0f - keep);
+        metrics.peak = std::max(peak_value, metrics.peak * static_cast<float>(std::pow(0.95, frames)));
+    } else {
+        const float decay = static_cast<float>(std::pow(0.98, frames));
+        metrics.rms *= decay;
+        metrics.peak *= decay;
+    }
+    return peak_value;
+}
+
+DspWorker::DspWorker(AudioEngine& audio,
+                     std::unique_ptr<DspEngine> dsp,
+                     std::size_t batch_samples,
+                     Wakeup* publish_signal,
+                     double idle_after_s)
+    : audio_(audio),
+      dsp_(std::move(dsp)),
+      batch_samples_(std::max<std::size_t>(1, batch_samples / audio.channels()) * audio.channels()),
+      straddle_(audio.channels()),
+      snapshots_(AnalysisSnapshot{dsp_->band_energies(), 0.0f, AudioMetrics{}, 0}),
+      publish_signal_(publish_signal),
+      idle_after_(std::max(idle_after_s, 0.0)),
+      stop_thread_(false) {}
+
+DspWorker::~DspWorker() { stop(); }
+
+void DspWorker::start() {
+    if (thread_.joinable()) {
+        return;
+    }
+    metrics_ = AudioMetrics{};
+    metrics_.active = true;
+    publish();
+    stop_thread_.store(false, std::memory_order_relaxed);
+    thread_ = std::thread(&DspWorker::run, this);
+}
+
+void DspWorker::stop() {
+    stop_thread_.store(true, std::memory_order_relaxed);
+    audio_.samples_ready().notify();
+    stop_signal_.notify();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+const AnalysisSnapshot& DspWorker::latest() {
+    snapshots_.update();
+    return snapshots_.read_buffer();
+}
+
+void DspWorker::run() {
+    const double hop_seconds = static_cast<double>(dsp_->hop_size()) / static_cast<double>(dsp_->sample_rate());
+    const auto poll_interval = std::clamp(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::duration<double>(hop_seconds * 0.5)),
+        kMinPollInterval,
+        kMaxPollInterval);
+    const auto idle_poll_interval = std::min<std::chrono::microseconds>(
+        kIdlePollInterval,
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::duration<double>(audio_.ring_seconds() * 0.5)));
+
+    auto last_update = std::chrono::steady_clock::now();
+    auto last_sound = last_update;
+    std::uint64_t published_frames = dsp_->frames_processed();
+    bool idle = false;
+    while (!stop_thread_.load(std::memory_order_relaxed)) {
+        const RingSpan<float> samples = audio_.reserve_samples(batch_samples_);
+        const std::size_t samples_read = samples.size();
+
+        const auto now = std::chrono::steady_clock::now();
+        const double elapsed_s = std::chrono::duration<double>(now - last_update).count();
+        last_update = now;
+        const float peak = update_audio_metrics(metrics_, samples, elapsed_s);
+        metrics_.dropped = audio_.dropped_samples();
+        if (peak >= kSilencePeak) {
+            last_sound = now;
+        }
+        // While idle, silence is only scanned for its level, not analysed.
+        if (!idle || peak >= kSilencePeak) {
+            analyse(samples);
+        }
+        audio_.commit_samples(samples_read);
+
+        const bool silent = idle_after_.count() > 0.0 && now - last_sound >= idle_after_;
+        if (!silent) {
+            // New analysis, or a device that stopped delivering and whose
+            // metrics are decaying.
+            if (dsp_->frames_processed() != published_frames || samples_read == 0) {
+                published_frames = dsp_->frames_processed();
+                publish();
+            }
+            idle = false;
+        } else if (!idle) {
+            publish();
+            idle = true;
+        }
+
+        if (idle) {
+            // A device delivering silence notifies on every callback; sleeping
+            // through those is what keeps idling cheap.
+            stop_signal_.wait_for(idle_poll_interval);
+        } else if (samples_read < batch_samples_) {
+            audio_.samples_ready().wait_for(poll_interval);
+        }
+    }
+}
+
+void DspWorker::analyse(const RingSpan<float>& samples) {
+    const std::size_t channels = straddle_.size();
+    const std::size_t whole = samples.first_size / channels * channels;
+    dsp_->push_samples(samples.first, whole);
+    // With a channel count that does not divide the ring's power-of-two size,
+    // one frame can wrap around its end; only that frame is copied.
+    std::size_t skip = 0;
+    if (whole < samples.first_size) {
+        const std::size_t head = samples.first_size - whole;
+        skip = channels - head;
+        std::copy(samples.first + whole, samples.first + samples.first_size, straddle_.begin());
+        std::copy(samples.second, samples.second + skip, straddle_.begin() + static_cast<std::ptrdiff_t>(head));
+        dsp_->push_samples(straddle_.data(), channels);
+    }
+    dsp_->push_samples(samples.second + skip, samples.second_size - skip);
+}
+
+void DspWorker::publish() {
+    AnalysisSnapshot& slot = snapshots_.write_buffer();
+    const std::vector<float>& bands = dsp_->band_energies();
+    slot.bands.assign(bands.begin(), bands.end());
+    slot.beat_strength = dsp_->beat_strength();
+    slot.metrics = metrics_;
+    slot.sequence = ++sequence_;
+    snapshots_.publish();
+    if (publish_signal_) {
+        publish_signal_->notify();
+    }
+}
+
+} // namespace who
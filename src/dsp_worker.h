@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "audio_engine.h"
+#include "dsp.h"
+#include "triple_buffer.h"
+#include "wakeup.h"
+
+namespace who {
+
+struct AnalysisSnapshot {
+    std::vector<float> bands;
+    float beat_strength = 0.0f;
+    AudioMetrics metrics{};
+    std::uint64_t sequence = 0;
+};
+
+// Provides the newest analysis to the render thread.
+class AnalysisSource {
+public:
+    virtual ~AnalysisSource() = default;
+
+    // Render-thread side: swaps in the newest published snapshot, if any.
+    virtual const AnalysisSnapshot& latest() = 0;
+};
+
+// Folds new samples (none when the input stalled) covering `elapsed_s` into
+// the smoothed RMS and peak; returns the peak of the new samples.
+float update_audio_metrics(AudioMetrics& metrics, const RingSpan<float>& samples, double elapsed_s);
+
+// Owns the DspEngine and runs it on its own thread, analysing up to
+// `batch_samples` at a time straight from the audio ring's memory and
+// publishing band energies, beat strength and input metrics through a wait-free
+// triple buffer so rendering never blocks analysis (or vice versa).
+//
+// The worker sleeps until the audio ring signals new samples and publishes
+// (and notifies publish_signal) only when a hop was analysed. After
+// idle_after_s seconds below -60 dBFS it publishes one last snapshot and stops
+// analysing and publishing until sound returns, only scanning incoming samples
+// for their level once every 250 ms (or half the ring, if shorter) whatever
+// notifications arrive; zero disables idling.
+class DspWorker final : public AnalysisSource {
+public:
+    DspWorker(AudioEngine& audio,
+              std::unique_ptr<DspEngine> dsp,
+              std::size_t batch_samples,
+              Wakeup* publish_signal = nullptr,
+              double idle_after_s = 0.0);
+    ~DspWorker();
+
+    DspWorker(const DspWorker&) = delete;
+    DspWorker& operator=(const DspWorker&) = delete;
+
+    void start();
+    void stop();
+
+    const AnalysisSnapshot& latest() override;
+
+private:
+    void run();
+    void analyse(const RingSpan<float>& samples);
+    void publish();
+
+    AudioEngine& audio_;
+    std::unique_ptr<DspEngine> dsp_;
+    std::size_t batch_samples_;
+    // One frame split across the end of the ring.
+    std::vector<float> straddle_;
+    AudioMetrics metrics_{};
+    std::uint64_t sequence_ = 0;
+    TripleBuffer<AnalysisSnapshot> snapshots_;
+    Wakeup* publish_signal_;
+    std::chrono::duration<double> idle_after_;
+
+    std::thread thread_;
+    std::atomic<bool> stop_thread_;
+    // Wakes the worker from its idle sleep on stop().
+    Wakeup stop_signal_;
+};
+
+} // namespace who
@@ -0,0 +1,440 @@
+#include "feature_file.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "file_decoder.h"
+#include "thread_pool.h"
+
+namespace who {
+
+namespace {
+
+constexpr char kMagic[8] = {'W', 'H', 'O', 'F', 'E', 'A', 'T', '1'};
+// Version 2 added the source and options hashes.
+constexpr std::uint32_t kVersion = 2;
+constexpr std::uint64_t kHashSeed = 0xcbf29ce484222325ull;
+constexpr std::uint64_t kHashPrime = 0x100000001b3ull;
+constexpr std::size_t kHashChunk = 1 << 20;
+// Beat strength, RMS and peak follow the bands.
+constexpr std::uint32_t kExtraFloats = 3;
+// Far above any filterbank; guards against headers that would overflow.
+constexpr std::uint32_t kMaxBands = 65536;
+// Longest wait for new audio while following the stream.
+constexpr std::chrono::milliseconds kFollowPollInterval{50};
+
+FeatureHeader make_header(std::uint32_t sample_rate, std::uint32_t hop_size, std::uint32_t bands) {
+    FeatureHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.header_size = sizeof(FeatureHeader);
+    header.sample_rate = sample_rate;
+    header.hop_size = hop_size;
+    header.bands = bands;
+    header.record_floats = bands + kExtraFloats;
+    return header;
+}
+
+// FNV-1a over 64-bit words: every step is a bijection, so any single changed
+// word changes the result.
+std::uint64_t hash_word(std::uint64_t hash, std::uint64_t word) { return (hash ^ word) * kHashPrime; }
+
+std::uint64_t hash_float(std::uint64_t hash, float value) {
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return hash_word(hash, bits);
+}
+
+std::uint64_t finish_hash(std::uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// Reads only the header of an existing feature file.
+bool read_header(const std::string& path, FeatureHeader& header) {
+    std::ifstream file(path, std::ios::binary);
+    return file && file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+           std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == kVersion;
+}
+
+} // namespace
+
+std::uint64_t hash_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("failed to open '" + path + "'");
+    }
+    std::vector<char> chunk(kHashChunk);
+    std::uint64_t hash = kHashSeed;
+    std::uint64_t length = 0;
+    while (file) {
+        file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        const std::size_t size = static_cast<std::size_t>(file.gcount());
+        std::size_t offset = 0;
+        for (; offset + sizeof(std::uint64_t) <= size; offset += sizeof(std::uint64_t)) {
+            std::uint64_t word = 0;
+            std::memcpy(&word, chunk.data() + offset, sizeof(word));
+            hash = hash_word(hash, word);
+        }
+        for (; offset < size; ++offset) {
+            hash = hash_word(hash, static_cast<unsigned char>(chunk[offset]));
+        }
+        length += size;
+    }
+    if (file.bad()) {
+        throw std::runtime_error("failed to read '" + path + "'");
+    }
+    return finish_hash(hash_word(hash, length));
+}
+
+std::uint64_t hash_analysis_options(std::uint32_t sample_rate, const DspOptions& options) {
+    std::uint64_t hash = kHashSeed;
+    hash = hash_word(hash, sample_rate);
+    hash = hash_word(hash, options.fft_size);
+    hash = hash_word(hash, options.hop_size);
+    hash = hash_word(hash, options.bands);
+    hash = hash_word(hash, static_cast<std::uint64_t>(options.transform));
+    hash = hash_word(hash, static_cast<std::uint64_t>(options.layout.scale));
+    hash = hash_float(hash, options.layout.min_frequency);
+    hash = hash_float(hash, options.layout.max_frequency);
+    hash = hash_word(hash, options.resolutions.size());
+    for (const std::size_t resolution : options.resolutions) {
+        hash = hash_word(hash, resolution);
+    }
+    hash = hash_word(hash, static_cast<std::uint64_t>(options.window));
+    hash = hash_float(hash, options.kaiser_beta);
+    hash = hash_float(hash, options.smoothing_attack);
+    hash = hash_float(hash, options.smoothing_release);
+    hash = hash_float(hash, options.beat_sensitivity);
+    hash = hash_word(hash, options.enable_flux ? 1 : 0);
+    // The backlog policy is not hashed: analysis always runs every hop.
+    return finish_hash(hash);
+}
+
+AnalysisSummary analyze_file(const std::string& input,
+                             const std::string& output,
+                             std::uint32_t sample_rate,
+                             const DspOptions& options,
+                             std::uint64_t source_hash) {
+    FileDecoder decoder(input, sample_rate);
+    DspOptions analysis_options = options;
+    // Every hop is recorded, however far ahead of real time.
+    analysis_options.backlog = BacklogPolicy::All;
+    DspEngine dsp(sample_rate, 1, analysis_options);
+
+    const std::string partial = output + ".partial";
+    std::ofstream file(partial, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("failed to create '" + partial + "'");
+    }
+    FeatureHeader header = make_header(sample_rate,
+                                       static_cast<std::uint32_t>(dsp.hop_size()),
+                                       static_cast<std::uint32_t>(dsp.band_energies().size()));
+    header.source_hash = source_hash;
+    header.options_hash = hash_analysis_options(sample_rate, options);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    const std::size_t hop_size = dsp.hop_size();
+    const double sample_seconds = 1.0 / static_cast<double>(sample_rate);
+    std::vector<float> record(header.record_floats);
+    AudioMetrics metrics{};
+    std::size_t hop_fill = 0;
+    const float* block = nullptr;
+    while (const std::size_t frames = decoder.read(block)) {
+        header.source_frames += frames;
+        std::size_t offset = 0;
+        while (offset < frames) {
+            // Feeds the engine up to each hop boundary, so every analysed hop
+            // is seen before the next one overwrites it.
+            const std::size_t chunk = std::min(frames - offset, hop_size - hop_fill);
+            dsp.push_samples(block + offset, chunk);
+            update_audio_metrics(metrics,
+                                 RingSpan<float>{block + offset, chunk, nullptr, 0},
+                                 static_cast<double>(chunk) * sample_seconds);
+            offset += chunk;
+            hop_fill += chunk;
+            if (hop_fill < hop_size) {
+                continue;
+            }
+            hop_fill = 0;
+            const std::vector<float>& bands = dsp.band_energies();
+            std::copy(bands.begin(), bands.end(), record.begin());
+            record[header.bands] = dsp.beat_strength();
+            record[header.bands + 1] = metrics.rms;
+            record[header.bands + 2] = metrics.peak;
+            file.write(reinterpret_cast<const char*>(record.data()),
+                       static_cast<std::streamsize>(record.size() * sizeof(float)));
+            ++header.hop_count;
+        }
+    }
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+    std::error_code error;
+    if (file) {
+        std::filesystem::rename(partial, output, error);
+    }
+    if (!file || error) {
+        std::remove(partial.c_str());
+        throw std::runtime_error("failed to write '" + output + "'");
+    }
+    return AnalysisSummary{header.hop_count, static_cast<double>(header.source_frames) * sample_seconds};
+}
+
+std::size_t analysis_threads(std::size_t threads, std::size_t jobs) {
+    return std::min(std::max<std::size_t>(threads, 1), std::max<std::size_t>(jobs, 1));
+}
+
+std::vector<AnalysisOutcome> analyze_batch(const std::vector<AnalysisJob>& jobs,
+                                           std::uint32_t sample_rate,
+                                           const DspOptions& options,
+                                           std::size_t threads,
+                                           bool force,
+                                           const BatchCallback& report) {
+    std::vector<AnalysisOutcome> outcomes(jobs.size());
+    // Largest first: with one file per task, a long file handed out last
+    // would leave every other thread idle while it finishes.
+    std::vector<std::uintmax_t> sizes(jobs.size(), 0);
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+        std::error_code error;
+        const std::uintmax_t size = std::filesystem::file_size(jobs[i].input, error);
+        sizes[i] = error ? 0 : size;
+    }
+    std::vector<std::size_t> order(jobs.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return sizes[a] > sizes[b]; });
+
+    const std::uint64_t options_hash = hash_analysis_options(sample_rate, options);
+    const auto start = std::chrono::steady_clock::now();
+    std::mutex report_mutex;
+    BatchProgress progress;
+    progress.total = jobs.size();
+
+    // The calling thread drains the loop too.
+    ThreadPool pool(analysis_threads(threads, jobs.size()) - 1);
+    pool.parallel_for(order.size(), [&](std::size_t slot) {
+        const std::size_t index = order[slot];
+        const AnalysisJob& job = jobs[index];
+        AnalysisOutcome& outcome = outcomes[index];
+        try {
+            const std::uint64_t source_hash = hash_file(job.input);
+            FeatureHeader existing{};
+            if (!force && read_header(job.output, existing) && existing.source_hash == source_hash &&
+                existing.options_hash == options_hash) {
+                outcome.status = AnalysisStatus::Skipped;
+                outcome.summary = AnalysisSummary{
+                    existing.hop_count,
+                    static_cast<double>(existing.source_frames) / static_cast<double>(existing.sample_rate)};
+            } else {
+                outcome.summary = analyze_file(job.input, job.output, sample_rate, options, source_hash);
+                outcome.status = AnalysisStatus::Analyzed;
+            }
+        } catch (const std::exception& error) {
+            outcome.status = AnalysisStatus::Failed;
+            outcome.error = error.what();
+        }
+
+        std::lock_guard<std::mutex> lock(report_mutex);
+        ++progress.completed;
+        if (outcome.status == AnalysisStatus::Analyzed) {
+            progress.audio_seconds += outcome.summary.audio_seconds;
+        }
+        progress.elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (report) {
+            report(job, outcome, progress);
+        }
+    });
+    return outcomes;
+}
+
+FeatureFile::FeatureFile(const std::string& path) {
+#if defined(_WIN32)
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("failed to open feature file '" + path + "'");
+    }
+    buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("failed to open feature file '" + path + "'");
+    }
+    struct stat file_info {};
+    if (::fstat(fd, &file_info) != 0 || file_info.st_size < static_cast<off_t>(sizeof(FeatureHeader))) {
+        ::close(fd);
+        throw std::runtime_error("'" + path + "' is not a feature file");
+    }
+    size_ = static_cast<std::size_t>(file_info.st_size);
+    void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("failed to map feature file '" + path + "'");
+    }
+    // Playback walks the hops in order.
+    ::madvise(mapping, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const std::uint8_t*>(mapping);
+#endif
+
+    const auto fail = [&](const std::string& reason) {
+        unmap();
+        throw std::runtime_error("'" + path + "' " + reason);
+    };
+    if (size_ < sizeof(FeatureHeader) || std::memcmp(header().magic, kMagic, sizeof(kMagic)) != 0) {
+        fail("is not a feature file");
+    }
+    const FeatureHeader& info = header();
+    if (info.version != kVersion || info.header_size != sizeof(FeatureHeader)) {
+        fail("has an unsupported feature file version");
+    }
+    if (info.sample_rate == 0 || info.hop_size == 0 || info.bands == 0 || info.bands > kMaxBands ||
+        static_cast<std::uint64_t>(info.record_floats) != static_cast<std::uint64_t>(info.bands) + kExtraFloats) {
+        fail("has a malformed header");
+    }
+    const std::uint64_t record_bytes = static_cast<std::uint64_t>(info.record_floats) * sizeof(float);
+    if (record_bytes == 0 || info.hop_count == 0 || (size_ - sizeof(FeatureHeader)) / record_bytes < info.hop_count) {
+        fail("is truncated or holds no hops");
+    }
+}
+
+FeatureFile::~FeatureFile() { unmap(); }
+
+void FeatureFile::unmap() {
+#if !defined(_WIN32)
+    if (data_) {
+        ::munmap(const_cast<std::uint8_t*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+}
+
+FeatureHop FeatureFile::hop(std::uint64_t index) const {
+    const FeatureHeader& info = header();
+    const float* record = reinterpret_cast<const float*>(data_ + sizeof(FeatureHeader)) +
+                          static_cast<std::size_t>(index) * info.record_floats;
+    return FeatureHop{record, record[info.bands], record[info.bands + 1], record[info.bands + 2]};
+}
+
+FeaturePlayer::FeaturePlayer(const FeatureFile& features, Wakeup* publish_signal, AudioEngine* audio)
+    : features_(features),
+      publish_signal_(publish_signal),
+      audio_(audio),
+      snapshots_(AnalysisSnapshot{std::vector<float>(features.bands(), 0.0f), 0.0f, AudioMetrics{}, 0}),
+      stop_thread_(false) {}
+
+FeaturePlayer::~FeaturePlayer() { stop(); }
+
+void FeaturePlayer::start() {
+    if (thread_.joinable()) {
+        return;
+    }
+    stop_thread_.store(false, std::memory_order_relaxed);
+    thread_ = std::thread(&FeaturePlayer::run, this);
+}
+
+void FeaturePlayer::stop() {
+    stop_thread_.store(true, std::memory_order_relaxed);
+    stop_signal_.notify();
+    if (audio_) {
+        audio_->samples_ready().notify();
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+const AnalysisSnapshot& FeaturePlayer::latest() {
+    snapshots_.update();
+    return snapshots_.read_buffer();
+}
+
+void FeaturePlayer::run() {
+    if (audio_) {
+        follow_audio();
+        return;
+    }
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    const double hop_seconds = features_.hop_seconds();
+    std::uint64_t hops_played = 0;
+    while (!stop_thread_.load(std::memory_order_relaxed)) {
+        publish(hops_played % features_.hop_count());
+        ++hops_played;
+        // Deadlines come from the start time, like realtime file pacing, so
+        // the tracks stay locked to the audio clock.
+        const auto due = start + std::chrono::duration_cast<Clock::duration>(
+                                     std::chrono::duration<double>(static_cast<double>(hops_played) * hop_seconds));
+        const auto now = Clock::now();
+        if (due > now) {
+            stop_signal_.wait_for(due - now);
+        } else {
+            // Fell behind (e.g. a suspended process): skip to the current hop.
+            hops_played = static_cast<std::uint64_t>(std::chrono::duration<double>(now - start).count() / hop_seconds);
+        }
+    }
+}
+
+void FeaturePlayer::follow_audio() {
+    const double hop_seconds = features_.hop_seconds();
+    const double loop_seconds = features_.source_seconds();
+    const double frame_seconds = 1.0 / static_cast<double>(audio_->sample_rate());
+    const std::size_t channels = audio_->channels();
+    std::uint64_t frames = 0;
+    std::uint64_t published = features_.hop_count();
+    while (!stop_thread_.load(std::memory_order_relaxed)) {
+        // Nothing is analysed: the samples only advance the clock.
+        const RingSpan<float> samples = audio_->reserve_samples(std::numeric_limits<std::size_t>::max());
+        audio_->commit_samples(samples.size());
+        frames += samples.size() / channels;
+
+        double position = static_cast<double>(frames) * frame_seconds;
+        if (loop_seconds > 0.0) {
+            position = std::fmod(position, loop_seconds);
+        }
+        // Hop k is complete once (k + 1) hops of audio have streamed.
+        const auto completed = static_cast<std::uint64_t>(position / hop_seconds);
+        const std::uint64_t index = std::min(completed > 0 ? completed - 1 : 0, features_.hop_count() - 1);
+        if (index != published) {
+            published = index;
+            publish(index);
+        }
+        audio_->samples_ready().wait_for(kFollowPollInterval);
+    }
+}
+
+void FeaturePlayer::publish(std::uint64_t index) {
+    const FeatureHop hop = features_.hop(index);
+    AnalysisSnapshot& slot = snapshots_.write_buffer();
+    slot.bands.assign(hop.bands, hop.bands + features_.bands());
+    slot.beat_strength = hop.beat_strength;
+    slot.metrics.active = true;
+    slot.metrics.rms = hop.rms;
+    slot.metrics.peak = hop.peak;
+    slot.sequence = ++sequence_;
+    snapshots_.publish();
+    if (publish_signal_) {
+        publish_signal_->notify();
+    }
+}
+
+} // namespace who
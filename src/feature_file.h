@@ -0,0 +1,178 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dsp.h"
+#include "dsp_worker.h"
+#include "triple_buffer.h"
+#include "wakeup.h"
+
+namespace who {
+
+// Precomputed feature tracks (`who analyze`). A 64-byte header is followed by
+// one fixed-size record per DSP hop, all little-endian and 4-byte aligned, so
+// the file is used in place through a read-only mapping:
+//   float bands[bands], float beat_strength, float rms, float peak
+// RMS and peak are the smoothed input metrics a live DspWorker would show.
+// The source and options hashes let a batch run skip files that are current.
+struct FeatureHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t header_size;
+    std::uint32_t sample_rate;
+    std::uint32_t hop_size;
+    std::uint32_t bands;
+    std::uint32_t record_floats;
+    std::uint64_t hop_count;
+    std::uint64_t source_frames;
+    std::uint64_t source_hash;
+    std::uint64_t options_hash;
+};
+static_assert(sizeof(FeatureHeader) == 64, "FeatureHeader is an on-disk layout");
+
+struct FeatureHop {
+    const float* bands;
+    float beat_strength;
+    float rms;
+    float peak;
+};
+
+struct AnalysisSummary {
+    std::uint64_t hops = 0;
+    double audio_seconds = 0.0;
+};
+
+// Content hash of a whole file; throws std::runtime_error when unreadable.
+std::uint64_t hash_file(const std::string& path);
+// Hash of everything that changes the analysis output.
+std::uint64_t hash_analysis_options(std::uint32_t sample_rate, const DspOptions& options);
+
+// Decodes `input` at `sample_rate` and runs it through a DspEngine as fast as
+// possible, writing every hop to `output`. The file is written under a
+// temporary name and renamed into place, so readers never see a partial one.
+// Throws std::runtime_error on decode or write errors.
+AnalysisSummary analyze_file(const std::string& input,
+                             const std::string& output,
+                             std::uint32_t sample_rate,
+                             const DspOptions& options,
+                             std::uint64_t source_hash = 0);
+
+struct AnalysisJob {
+    std::string input;
+    std::string output;
+};
+
+enum class AnalysisStatus {
+    Analyzed,
+    // The output already holds this input's analysis with the same options.
+    Skipped,
+    Failed,
+};
+
+struct AnalysisOutcome {
+    AnalysisStatus status = AnalysisStatus::Failed;
+    AnalysisSummary summary;
+    std::string error;
+};
+
+// Totals over the jobs finished so far; audio_seconds counts analysed files
+// only.
+struct BatchProgress {
+    std::size_t completed = 0;
+    std::size_t total = 0;
+    double audio_seconds = 0.0;
+    double elapsed_s = 0.0;
+};
+
+// Called after each job, never concurrently.
+using BatchCallback = std::function<void(const AnalysisJob&, const AnalysisOutcome&, const BatchProgress&)>;
+
+// Threads analyze_batch actually uses: `threads`, at least one and at most one
+// per job.
+std::size_t analysis_threads(std::size_t threads, std::size_t jobs);
+
+// Analyses the jobs on analysis_threads() threads (the caller's included), one
+// decoder and DspEngine per file, largest inputs first so a long file does not
+// start last. Unless `force`, jobs whose output is current are skipped. Returns one
+// outcome per job, in job order.
+std::vector<AnalysisOutcome> analyze_batch(const std::vector<AnalysisJob>& jobs,
+                                           std::uint32_t sample_rate,
+                                           const DspOptions& options,
+                                           std::size_t threads,
+                                           bool force = false,
+                                           const BatchCallback& report = {});
+
+// Read-only view of a feature file, mapped into memory where the platform
+// allows it.
+class FeatureFile {
+public:
+    // Throws std::runtime_error when the file is missing or malformed.
+    explicit FeatureFile(const std::string& path);
+    ~FeatureFile();
+
+    FeatureFile(const FeatureFile&) = delete;
+    FeatureFile& operator=(const FeatureFile&) = delete;
+
+    const FeatureHeader& header() const { return *reinterpret_cast<const FeatureHeader*>(data_); }
+    std::uint64_t hop_count() const { return header().hop_count; }
+    std::size_t bands() const { return header().bands; }
+    double hop_seconds() const {
+        return static_cast<double>(header().hop_size) / static_cast<double>(header().sample_rate);
+    }
+    // Length of the analysed audio.
+    double source_seconds() const {
+        return static_cast<double>(header().source_frames) / static_cast<double>(header().sample_rate);
+    }
+    FeatureHop hop(std::uint64_t index) const;
+
+private:
+    void unmap();
+
+    const std::uint8_t* data_ = nullptr;
+    std::size_t size_ = 0;
+    // Fallback copy where memory mapping is unavailable.
+    std::vector<std::uint8_t> buffer_;
+};
+
+// Replaces the DSP thread with a feature file, looping at the end like file
+// streaming. With an `audio` clock (the analysed file streaming through an
+// AudioEngine) it consumes the ring in place of the DSP worker and publishes
+// the last hop the streamed audio has completed, so the tracks follow the
+// audio's own position. Without one it runs on its own clock from start(),
+// publishing at the analysis hop rate.
+class FeaturePlayer final : public AnalysisSource {
+public:
+    FeaturePlayer(const FeatureFile& features, Wakeup* publish_signal = nullptr, AudioEngine* audio = nullptr);
+    ~FeaturePlayer();
+
+    FeaturePlayer(const FeaturePlayer&) = delete;
+    FeaturePlayer& operator=(const FeaturePlayer&) = delete;
+
+    void start();
+    void stop();
+
+    const AnalysisSnapshot& latest() override;
+
+private:
+    void run();
+    void follow_audio();
+    void publish(std::uint64_t index);
+
+    const FeatureFile& features_;
+    Wakeup* publish_signal_;
+    AudioEngine* audio_;
+    TripleBuffer<AnalysisSnapshot> snapshots_;
+    std::uint64_t sequence_ = 0;
+
+    std::thread thread_;
+    std::atomic<bool> stop_thread_;
+    Wakeup stop_signal_;
+};
+
+} // namespace who
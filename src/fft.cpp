@@ -0,0 +1,133 @@
+#include "fft.h"
+
+#include "fft_fixed.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace who {
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+
+struct FixedKernelEntry {
+    std::size_t size;
+    ComplexFftKernel kernel;
+};
+
+// Specialisations cover the common fft_size values and, for the real path,
+// their half-size inner transforms.
+constexpr FixedKernelEntry kFixedKernels[] = {
+    {128, &fft_fixed::forward<128>},
+    {256, &fft_fixed::forward<256>},
+    {512, &fft_fixed::forward<512>},
+    {1024, &fft_fixed::forward<1024>},
+    {2048, &fft_fixed::forward<2048>},
+    {4096, &fft_fixed::forward<4096>},
+};
+
+} // namespace
+
+ComplexFftKernel fixed_complex_fft(std::size_t size) {
+    for (const FixedKernelEntry& entry : kFixedKernels) {
+        if (entry.size == size) {
+            return entry.kernel;
+        }
+    }
+    return nullptr;
+}
+
+FftPlan::FftPlan(std::size_t size, FftTransform transform)
+    : size_(size), transform_(transform), kernel_(nullptr), cfg_(nullptr) {
+    if (size_ < 2 || (size_ & (size_ - 1)) != 0) {
+        throw std::invalid_argument("FFT size must be a power of two greater than 1");
+    }
+
+    const std::size_t complex_size = (transform_ == FftTransform::Real) ? size_ / 2 : size_;
+    kernel_ = fixed_complex_fft(complex_size);
+    if (!kernel_) {
+        cfg_ = kiss_fft_alloc(static_cast<int>(complex_size), 0, nullptr, nullptr);
+        if (!cfg_) {
+            throw std::runtime_error("Failed to allocate FFT config");
+        }
+    }
+
+    if (transform_ == FftTransform::Real) {
+        const std::size_t half = size_ / 2;
+        scratch_out_.resize(half);
+        super_twiddles_.resize(half / 2);
+        for (std::size_t i = 0; i < super_twiddles_.size(); ++i) {
+            const double phase = -kPi * (static_cast<double>(i + 1) / static_cast<double>(half) + 0.5);
+            super_twiddles_[i].r = static_cast<float>(std::cos(phase));
+            super_twiddles_[i].i = static_cast<float>(std::sin(phase));
+        }
+    } else {
+        scratch_in_.resize(size_);
+        scratch_out_.resize(size_);
+    }
+}
+
+FftPlan::~FftPlan() {
+    if (cfg_) {
+        kiss_fft_free(cfg_);
+        cfg_ = nullptr;
+    }
+}
+
+void FftPlan::forward(const float* input, kiss_fft_cpx* spectrum) {
+    if (transform_ == FftTransform::Real) {
+        forward_real(input, spectrum);
+    } else {
+        forward_complex(input, spectrum);
+    }
+}
+
+void FftPlan::run_complex(const kiss_fft_cpx* input, kiss_fft_cpx* output) {
+    if (kernel_) {
+        kernel_(input, output);
+    } else {
+        kiss_fft(cfg_, input, output);
+    }
+}
+
+void FftPlan::forward_complex(const float* input, kiss_fft_cpx* spectrum) {
+    for (std::size_t i = 0; i < size_; ++i) {
+        scratch_in_[i].r = input[i];
+        scratch_in_[i].i = 0.0f;
+    }
+    run_complex(scratch_in_.data(), scratch_out_.data());
+    for (std::size_t i = 0; i < bins(); ++i) {
+        spectrum[i] = scratch_out_[i];
+    }
+}
+
+void FftPlan::forward_real(const float* input, kiss_fft_cpx* spectrum) {
+    const std::size_t half = size_ / 2;
+
+    // Even samples become the real part and odd samples the imaginary part of
+    // a half-length complex sequence; kiss_fft_cpx is two packed floats.
+    run_complex(reinterpret_cast<const kiss_fft_cpx*>(input), scratch_out_.data());
+
+    const kiss_fft_cpx dc = scratch_out_[0];
+    spectrum[0].r = dc.r + dc.i;
+    spectrum[0].i = 0.0f;
+    spectrum[half].r = dc.r - dc.i;
+    spectrum[half].i = 0.0f;
+
+    for (std::size_t k = 1; k <= half / 2; ++k) {
+        const kiss_fft_cpx fpk = scratch_out_[k];
+        const kiss_fft_cpx fpnk{scratch_out_[half - k].r, -scratch_out_[half - k].i};
+
+        const kiss_fft_cpx f1k{fpk.r + fpnk.r, fpk.i + fpnk.i};
+        const kiss_fft_cpx f2k{fpk.r - fpnk.r, fpk.i - fpnk.i};
+        const kiss_fft_cpx twiddle = super_twiddles_[k - 1];
+        const kiss_fft_cpx tw{f2k.r * twiddle.r - f2k.i * twiddle.i, f2k.r * twiddle.i + f2k.i * twiddle.r};
+
+        spectrum[k].r = 0.5f * (f1k.r + tw.r);
+        spectrum[k].i = 0.5f * (f1k.i + tw.i);
+        spectrum[half - k].r = 0.5f * (f1k.r - tw.r);
+        spectrum[half - k].i = 0.5f * (tw.i - f1k.i);
+    }
+}
+
+} // namespace who
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+extern "C" {
+#include <kiss_fft.h>
+}
+
+namespace who {
+
+enum class FftTransform {
+    Complex,
+    Real,
+};
+
+using ComplexFftKernel = void (*)(const kiss_fft_cpx* input, kiss_fft_cpx* output);
+
+// Compile-time specialised complex FFT for `size` (powers of two from 128 to
+// 4096), or nullptr when the size has no specialisation and kiss_fft is used.
+ComplexFftKernel fixed_complex_fft(std::size_t size);
+
+// Forward transform of a real frame into its non-negative frequency bins.
+// The Real path packs even/odd samples into a half-size complex FFT and
+// untangles the result with a post-twiddle pass (the kiss_fftr scheme), so it
+// does about half the work of the Complex path for identical output.
+class FftPlan {
+public:
+    FftPlan(std::size_t size, FftTransform transform);
+    ~FftPlan();
+
+    FftPlan(const FftPlan&) = delete;
+    FftPlan& operator=(const FftPlan&) = delete;
+
+    // Reads size() samples and writes bins() = size() / 2 + 1 complex bins.
+    void forward(const float* input, kiss_fft_cpx* spectrum);
+
+    std::size_t size() const { return size_; }
+    std::size_t bins() const { return size_ / 2 + 1; }
+    FftTransform transform() const { return transform_; }
+
+private:
+    void forward_complex(const float* input, kiss_fft_cpx* spectrum);
+    void forward_real(const float* input, kiss_fft_cpx* spectrum);
+    void run_complex(const kiss_fft_cpx* input, kiss_fft_cpx* output);
+
+    std::size_t size_;
+    FftTransform transform_;
+    ComplexFftKernel kernel_;
+    kiss_fft_cfg cfg_;
+    std::vector<kiss_fft_cpx> scratch_in_;
+    std::vector<kiss_fft_cpx> scratch_out_;
+    std::vector<kiss_fft_cpx> super_twiddles_;
+};
+
+} // namespace who
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+extern "C" {
+#include <kiss_fft.h>
+}
+
+namespace who::fft_fixed {
+
+// Compile-time sized complex forward FFTs. Each size is a recursive radix-4
+// decimation-in-time transform (with one radix-2 stage for odd powers of two)
+// whose recursion depth, loop bounds and twiddle tables are all fixed at
+// compile time, replacing kiss_fft's runtime factor walk.
+
+namespace detail {
+
+constexpr double kPi = 3.14159265358979323846;
+
+constexpr double sin_series(double x) {
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 12; ++n) {
+        term *= -x * x / static_cast<double>((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double cos_series(double x) {
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 1; n < 12; ++n) {
+        term *= -x * x / static_cast<double>((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+// exp(-2*pi*i*k/n), reduced to an octant with exact integer arithmetic so the
+// series only ever sees |x| <= pi/4.
+constexpr kiss_fft_cpx forward_twiddle(std::size_t k, std::size_t n) {
+    const std::size_t quadrant = (4 * k) / n;
+    const std::size_t remainder = 4 * k - quadrant * n;
+    double s = 0.0;
+    double c = 0.0;
+    if (2 * remainder <= n) {
+        const double angle = (kPi / 2.0) * static_cast<double>(remainder) / static_cast<double>(n);
+        s = sin_series(angle);
+        c = cos_series(angle);
+    } else {
+        const double angle = (kPi / 2.0) * static_cast<double>(n - remainder) / static_cast<double>(n);
+        s = cos_series(angle);
+        c = sin_series(angle);
+    }
+    double cos_theta = c;
+    double sin_theta = s;
+    switch (quadrant % 4) {
+    case 1:
+        cos_theta = -s;
+        sin_theta = c;
+        break;
+    case 2:
+        cos_theta = -c;
+        sin_theta = -s;
+        break;
+    case 3:
+        cos_theta = s;
+        sin_theta = -c;
+        break;
+    default:
+        break;
+    }
+    return kiss_fft_cpx{static_cast<float>(cos_theta), static_cast<float>(-sin_theta)};
+}
+
+template <std::size_t N>
+constexpr std::array<kiss_fft_cpx, N> make_twiddles() {
+    std::array<kiss_fft_cpx, N> table{};
+    for (std::size_t k = 0; k < N; ++k) {
+        table[k] = forward_twiddle(k, N);
+    }
+    return table;
+}
+
+template <std::size_t N>
+struct Twiddles {
+    static constexpr std::array<kiss_fft_cpx, N> value = make_twiddles<N>();
+};
+
+inline kiss_fft_cpx add(kiss_fft_cpx a, kiss_fft_cpx b) { return {a.r + b.r, a.i + b.i}; }
+inline kiss_fft_cpx sub(kiss_fft_cpx a, kiss_fft_cpx b) { return {a.r - b.r, a.i - b.i}; }
+inline kiss_fft_cpx mul(kiss_fft_cpx a, kiss_fft_cpx b) { return {a.r * b.r - a.i * b.i, a.r * b.i + a.i * b.r}; }
+// Multiply by -i.
+inline kiss_fft_cpx rot_neg_i(kiss_fft_cpx a) { return {a.i, -a.r}; }
+
+template <std::size_t N>
+inline void transform(const kiss_fft_cpx* in, std::size_t stride, kiss_fft_cpx* out) {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "fixed FFT sizes must be powers of two");
+    if constexpr (N == 2) {
+        const kiss_fft_cpx a = in[0];
+        const kiss_fft_cpx b = in[stride];
+        out[0] = add(a, b);
+        out[1] = sub(a, b);
+    } else if constexpr (N == 4) {
+        const kiss_fft_cpx a0 = in[0];
+        const kiss_fft_cpx a1 = in[stride];
+        const kiss_fft_cpx a2 = in[2 * stride];
+        const kiss_fft_cpx a3 = in[3 * stride];
+        const kiss_fft_cpx s02 = add(a0, a2);
+        const kiss_fft_cpx d02 = sub(a0, a2);
+        const kiss_fft_cpx s13 = add(a1, a3);
+        const kiss_fft_cpx d13 = rot_neg_i(sub(a1, a3));
+        out[0] = add(s02, s13);
+        out[1] = add(d02, d13);
+        out[2] = sub(s02, s13);
+        out[3] = sub(d02, d13);
+    } else if constexpr (N == 8) {
+        constexpr std::size_t M = N / 2;
+        transform<M>(in, stride * 2, out);
+        transform<M>(in + stride, stride * 2, out + M);
+        const auto& tw = Twiddles<N>::value;
+        for (std::size_t k = 0; k < M; ++k) {
+            const kiss_fft_cpx a = out[k];
+            const kiss_fft_cpx b = mul(out[k + M], tw[k]);
+            out[k] = add(a, b);
+            out[k + M] = sub(a, b);
+        }
+    } else {
+        constexpr std::size_t M = N / 4;
+        transform<M>(in, stride * 4, out);
+        transform<M>(in + stride, stride * 4, out + M);
+        transform<M>(in + 2 * stride, stride * 4, out + 2 * M);
+        transform<M>(in + 3 * stride, stride * 4, out + 3 * M);
+        const auto& tw = Twiddles<N>::value;
+        for (std::size_t k = 0; k < M; ++k) {
+            const kiss_fft_cpx a0 = out[k];
+            const kiss_fft_cpx a1 = mul(out[k + M], tw[k]);
+            const kiss_fft_cpx a2 = mul(out[k + 2 * M], tw[2 * k]);
+            const kiss_fft_cpx a3 = mul(out[k + 3 * M], tw[3 * k]);
+            const kiss_fft_cpx s02 = add(a0, a2);
+            const kiss_fft_cpx d02 = sub(a0, a2);
+            const kiss_fft_cpx s13 = add(a1, a3);
+            const kiss_fft_cpx d13 = rot_neg_i(sub(a1, a3));
+            out[k] = add(s02, s13);
+            out[k + M] = add(d02, d13);
+            out[k + 2 * M] = sub(s02, s13);
+            out[k + 3 * M] = sub(d02, d13);
+        }
+    }
+}
+
+} // namespace detail
+
+template <std::size_t N>
+void forward(const kiss_fft_cpx* input, kiss_fft_cpx* output) {
+    detail::transform<N>(input, 1, output);
+}
+
+} // namespace who::fft_fixed
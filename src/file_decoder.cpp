@@ -0,0 +1,244 @@
+#include "file_decoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "simd_kernels.h"
+
+namespace who {
+
+namespace {
+constexpr std::size_t kChunkFrames = 512;
+
+constexpr std::uint16_t kWavePcm = 1;
+constexpr std::uint16_t kWaveFloat = 3;
+// WAVE_FORMAT_EXTENSIBLE: the real format tag opens the sub-format GUID.
+constexpr std::uint16_t kWaveExtensible = 0xfffe;
+
+std::uint16_t read_u16(const std::uint8_t* data) {
+    return static_cast<std::uint16_t>(data[0] | (data[1] << 8));
+}
+
+std::uint32_t read_u32(const std::uint8_t* data) {
+    return static_cast<std::uint32_t>(data[0]) | (static_cast<std::uint32_t>(data[1]) << 8) |
+           (static_cast<std::uint32_t>(data[2]) << 16) | (static_cast<std::uint32_t>(data[3]) << 24);
+}
+} // namespace
+
+FileDecoder::FileDecoder(const std::string& path, ma_uint32 sample_rate, bool allow_mapping)
+    : sample_rate_(sample_rate) {
+    ma_uint32 decoder_sample_rate = allow_mapping ? map_wav(path) : 0;
+    if (!map_) {
+        ma_decoder_config decoder_config = ma_decoder_config_init(ma_format_f32, 0, 0);
+        if (ma_decoder_init_file(path.c_str(), &decoder_config, &decoder_) != MA_SUCCESS) {
+            throw std::runtime_error("failed to open audio file '" + path + "'");
+        }
+        decoder_initialized_ = true;
+        decoder_channels_ = decoder_.outputChannels;
+        decoder_sample_rate = decoder_.outputSampleRate;
+        if (decoder_channels_ == 0) {
+            decoder_channels_ = 1;
+        }
+        decode_buffer_.resize(kChunkFrames * decoder_channels_);
+    }
+    if (decoder_sample_rate == 0) {
+        decoder_sample_rate = sample_rate_;
+    }
+
+    // Resampling runs on the mono downmix.
+    if (decoder_sample_rate != sample_rate_) {
+        ma_resampler_config resampler_config =
+            ma_resampler_config_init(ma_format_f32, 1, decoder_sample_rate, sample_rate_, ma_resample_algorithm_linear);
+        if (ma_resampler_init(&resampler_config, nullptr, &resampler_) != MA_SUCCESS) {
+            if (decoder_initialized_) {
+                ma_decoder_uninit(&decoder_);
+            }
+            unmap();
+            throw std::runtime_error("failed to initialize resampler for '" + path + "'");
+        }
+        resampler_initialized_ = true;
+        const double ratio = static_cast<double>(sample_rate_) / static_cast<double>(decoder_sample_rate);
+        resample_buffer_.resize(static_cast<std::size_t>(std::ceil(kChunkFrames * ratio)) + 8);
+    }
+
+    mono_buffer_.resize(kChunkFrames);
+}
+
+FileDecoder::~FileDecoder() {
+    if (resampler_initialized_) {
+        ma_resampler_uninit(&resampler_, nullptr);
+    }
+    if (decoder_initialized_) {
+        ma_decoder_uninit(&decoder_);
+    }
+    unmap();
+}
+
+ma_uint32 FileDecoder::map_wav(const std::string& path) {
+    // Samples are used in place, so the host must share WAV's byte order.
+#if defined(_WIN32) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    (void)path;
+    return 0;
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || info.st_size < 12) {
+        ::close(fd);
+        return 0;
+    }
+    const std::size_t size = static_cast<std::size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return 0;
+    }
+    map_ = static_cast<const std::uint8_t*>(mapping);
+    map_size_ = size;
+    if (std::memcmp(map_, "RIFF", 4) != 0 || std::memcmp(map_ + 8, "WAVE", 4) != 0) {
+        unmap();
+        return 0;
+    }
+
+    std::uint16_t format = 0;
+    std::uint16_t channels = 0;
+    std::uint32_t file_rate = 0;
+    std::uint16_t block_align = 0;
+    std::uint16_t bits = 0;
+    std::uint64_t data_offset = 0;
+    std::uint64_t data_size = 0;
+    std::uint64_t offset = 12;
+    while (offset + 8 <= size) {
+        const std::uint8_t* chunk = map_ + offset;
+        const std::uint64_t chunk_size = read_u32(chunk + 4);
+        const std::uint64_t body = offset + 8;
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && chunk_size >= 16 && body + 16 <= size) {
+            format = read_u16(chunk + 8);
+            channels = read_u16(chunk + 10);
+            file_rate = read_u32(chunk + 12);
+            block_align = read_u16(chunk + 20);
+            bits = read_u16(chunk + 22);
+            if (format == kWaveExtensible && chunk_size >= 40 && body + 40 <= size) {
+                format = read_u16(chunk + 32);
+            }
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            data_offset = body;
+            // Streamed or truncated files may claim more than is there.
+            data_size = std::min<std::uint64_t>(chunk_size, size - body);
+            break;
+        }
+        // Chunks are padded to an even size.
+        offset = body + chunk_size + (chunk_size & 1);
+    }
+
+    const bool f32 = format == kWaveFloat && bits == 32;
+    const bool s16 = format == kWavePcm && bits == 16;
+    const std::size_t sample_bytes = bits / 8;
+    if (data_offset == 0 || (!f32 && !s16) || channels == 0 || file_rate == 0 ||
+        block_align != channels * sample_bytes || data_offset % sample_bytes != 0) {
+        unmap();
+        return 0;
+    }
+
+    mapped_format_ = f32 ? MappedFormat::F32 : MappedFormat::S16;
+    decoder_channels_ = channels;
+    pcm_ = map_ + data_offset;
+    mapped_frames_ = data_size / block_align;
+    mapped_position_ = 0;
+    ::madvise(mapping, map_size_, MADV_SEQUENTIAL);
+    return file_rate;
+#endif
+}
+
+void FileDecoder::unmap() {
+#if !defined(_WIN32)
+    if (map_) {
+        ::munmap(const_cast<std::uint8_t*>(map_), map_size_);
+    }
+#endif
+    map_ = nullptr;
+    pcm_ = nullptr;
+}
+
+std::size_t FileDecoder::read(const float*& samples) {
+    while (true) {
+        const float* mono = nullptr;
+        const std::size_t frames = map_ ? read_mapped(mono) : read_decoded(mono);
+        if (frames == 0) {
+            return 0;
+        }
+        if (!resampler_initialized_) {
+            samples = mono;
+            return frames;
+        }
+
+        ma_uint64 input_frame_count = frames;
+        ma_uint64 output_frame_count = resample_buffer_.size();
+        if (ma_resampler_process_pcm_frames(&resampler_, mono, &input_frame_count, resample_buffer_.data(),
+                                            &output_frame_count) != MA_SUCCESS) {
+            continue;
+        }
+        if (output_frame_count == 0) {
+            continue;
+        }
+        samples = resample_buffer_.data();
+        return static_cast<std::size_t>(output_frame_count);
+    }
+}
+
+std::size_t FileDecoder::read_mapped(const float*& mono) {
+    const std::size_t frames =
+        static_cast<std::size_t>(std::min<std::uint64_t>(kChunkFrames, mapped_frames_ - mapped_position_));
+    if (frames == 0) {
+        return 0;
+    }
+    const std::size_t offset = static_cast<std::size_t>(mapped_position_) * decoder_channels_;
+    mapped_position_ += frames;
+    if (mapped_format_ == MappedFormat::S16) {
+        kernels::downmix_s16(reinterpret_cast<const std::int16_t*>(pcm_) + offset, frames, decoder_channels_,
+                             mono_buffer_.data());
+        mono = mono_buffer_.data();
+        return frames;
+    }
+    const float* source = reinterpret_cast<const float*>(pcm_) + offset;
+    if (decoder_channels_ == 1) {
+        mono = source;
+        return frames;
+    }
+    kernels::downmix(source, frames, decoder_channels_, mono_buffer_.data());
+    mono = mono_buffer_.data();
+    return frames;
+}
+
+std::size_t FileDecoder::read_decoded(const float*& mono) {
+    ma_uint64 frames_read = 0;
+    const ma_result result = ma_decoder_read_pcm_frames(&decoder_, decode_buffer_.data(), kChunkFrames, &frames_read);
+    if (result != MA_SUCCESS || frames_read == 0) {
+        return 0;
+    }
+    const std::size_t frames = static_cast<std::size_t>(frames_read);
+    kernels::downmix(decode_buffer_.data(), frames, decoder_channels_, mono_buffer_.data());
+    mono = mono_buffer_.data();
+    return frames;
+}
+
+bool FileDecoder::rewind() {
+    if (map_) {
+        mapped_position_ = 0;
+        return true;
+    }
+    return ma_decoder_seek_to_pcm_frame(&decoder_, 0) == MA_SUCCESS;
+}
+
+} // namespace who
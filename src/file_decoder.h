@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <miniaudio.h>
+
+namespace who {
+
+// Decodes an audio file to mono float samples at a fixed sample rate:
+// miniaudio decoding, then a downmix, then linear resampling when the file's
+// rate differs.
+//
+// WAV files holding 32-bit float or 16-bit PCM are instead memory-mapped and
+// read in place: conversion and downmix run as one pass over the mapped pages,
+// and mono float data at the target rate is handed out without any copy.
+class FileDecoder {
+public:
+    // Throws std::runtime_error when the file cannot be opened or decoded.
+    // `allow_mapping` = false forces the miniaudio path (benchmarks).
+    FileDecoder(const std::string& path, ma_uint32 sample_rate, bool allow_mapping = true);
+    ~FileDecoder();
+
+    FileDecoder(const FileDecoder&) = delete;
+    FileDecoder& operator=(const FileDecoder&) = delete;
+
+    // Decodes the next block; returns its frame count (0 at the end of the
+    // file) and points `samples` at it. The block stays valid until the next
+    // call.
+    std::size_t read(const float*& samples);
+    // Returns to the start of the file.
+    bool rewind();
+
+    ma_uint32 sample_rate() const { return sample_rate_; }
+    bool mapped() const { return map_ != nullptr; }
+
+private:
+    enum class MappedFormat { F32, S16 };
+
+    // Maps `path` when it is a WAV file the fast path handles; returns the
+    // file's sample rate, or 0 to fall back to miniaudio.
+    ma_uint32 map_wav(const std::string& path);
+    void unmap();
+    // The next block of mono samples at the file's rate.
+    std::size_t read_mapped(const float*& mono);
+    std::size_t read_decoded(const float*& mono);
+
+    ma_uint32 sample_rate_;
+    ma_decoder decoder_{};
+    bool decoder_initialized_ = false;
+    ma_uint32 decoder_channels_ = 0;
+
+    const std::uint8_t* map_ = nullptr;
+    std::size_t map_size_ = 0;
+    const std::uint8_t* pcm_ = nullptr;
+    MappedFormat mapped_format_ = MappedFormat::F32;
+    std::uint64_t mapped_frames_ = 0;
+    std::uint64_t mapped_position_ = 0;
+
+    ma_resampler resampler_{};
+    bool resampler_initialized_ = false;
+    std::vector<float> decode_buffer_;
+    std::vector<float> mono_buffer_;
+    std::vector<float> resample_buffer_;
+};
+
+} // namespace who
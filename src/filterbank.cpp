@@ -0,0 +1,124 @@
+#include "filterbank.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace who {
+
+namespace {
+
+constexpr float kMinFrequency = 1.0f;
+
+float to_scale(BandScale scale, float hz) {
+    switch (scale) {
+    case BandScale::Mel:
+        return 2595.0f * std::log10(1.0f + hz / 700.0f);
+    case BandScale::Bark:
+        return 26.81f * hz / (1960.0f + hz) - 0.53f;
+    case BandScale::Erb:
+        return 21.4f * std::log10(1.0f + 0.00437f * hz);
+    case BandScale::Log:
+    default:
+        return std::log(std::max(hz, kMinFrequency));
+    }
+}
+
+float from_scale(BandScale scale, float value) {
+    switch (scale) {
+    case BandScale::Mel:
+        return 700.0f * (std::pow(10.0f, value / 2595.0f) - 1.0f);
+    case BandScale::Bark:
+        return 1960.0f * (value + 0.53f) / (26.28f - value);
+    case BandScale::Erb:
+        return (std::pow(10.0f, value / 21.4f) - 1.0f) / 0.00437f;
+    case BandScale::Log:
+    default:
+        return std::exp(value);
+    }
+}
+
+} // namespace
+
+Filterbank::Filterbank(std::size_t bands, std::size_t fft_size, std::uint32_t sample_rate, const BandLayout& layout) {
+    row_offsets_.assign(1, 0);
+    if (bands == 0 || fft_size < 2 || sample_rate == 0) {
+        return;
+    }
+
+    const std::size_t last_bin_index = fft_size / 2;
+    const float bin_width = static_cast<float>(sample_rate) / static_cast<float>(fft_size);
+    const float nyquist = static_cast<float>(sample_rate) * 0.5f;
+    const float max_hz = (layout.max_frequency > 0.0f) ? std::min(layout.max_frequency, nyquist) : nyquist;
+    const float min_hz = std::clamp(layout.min_frequency, kMinFrequency, max_hz * 0.5f);
+
+    // bands + 2 equally spaced edges on the perceptual scale; band b rises from
+    // edge b to a peak at edge b + 1 and falls to zero at edge b + 2.
+    const float scale_min = to_scale(layout.scale, min_hz);
+    const float scale_max = to_scale(layout.scale, max_hz);
+    std::vector<float> edges(bands + 2);
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        const float t = static_cast<float>(i) / static_cast<float>(bands + 1);
+        edges[i] = from_scale(layout.scale, scale_min + (scale_max - scale_min) * t) / bin_width;
+    }
+
+    centers_.resize(bands);
+    row_offsets_.reserve(bands + 1);
+    for (std::size_t band = 0; band < bands; ++band) {
+        const float center = edges[band + 1];
+        // Keep every triangle at least one bin wide on each side so narrow low
+        // bands blend neighbouring bins instead of snapping to a single one.
+        const float lower = std::min(edges[band], center - 1.0f);
+        const float upper = std::max(edges[band + 2], center + 1.0f);
+        centers_[band] = center * bin_width;
+
+        const std::size_t row_start = bins_.size();
+        const std::size_t bin_begin = static_cast<std::size_t>(std::max(0.0f, std::ceil(lower)));
+        const std::size_t bin_end = std::min(last_bin_index, static_cast<std::size_t>(std::max(0.0f, std::floor(upper))));
+        float weight_sum = 0.0f;
+        for (std::size_t bin = bin_begin; bin <= bin_end; ++bin) {
+            const float position = static_cast<float>(bin);
+            float weight = 0.0f;
+            if (position <= center) {
+                weight = (position - lower) / (center - lower);
+            } else {
+                weight = (upper - position) / (upper - center);
+            }
+            if (weight <= 0.0f) {
+                continue;
+            }
+            bins_.push_back(static_cast<std::uint32_t>(bin));
+            weights_.push_back(weight);
+            weight_sum += weight;
+        }
+
+        if (bins_.size() == row_start) {
+            const std::size_t nearest = std::min(last_bin_index, static_cast<std::size_t>(std::lround(center)));
+            bins_.push_back(static_cast<std::uint32_t>(nearest));
+            weights_.push_back(1.0f);
+            weight_sum = 1.0f;
+        }
+
+        for (std::size_t i = row_start; i < weights_.size(); ++i) {
+            weights_[i] /= weight_sum;
+        }
+        row_offsets_.push_back(static_cast<std::uint32_t>(bins_.size()));
+    }
+}
+
+float Filterbank::apply_band(std::size_t band, const float* bin_power) const {
+    float energy = 0.0f;
+    const std::uint32_t end = row_offsets_[band + 1];
+    for (std::uint32_t i = row_offsets_[band]; i < end; ++i) {
+        energy += weights_[i] * bin_power[bins_[i]];
+    }
+    return energy;
+}
+
+void Filterbank::apply(const float* bin_power, float* band_power) const {
+    const std::size_t count = bands();
+    for (std::size_t band = 0; band < count; ++band) {
+        band_power[band] = apply_band(band, bin_power);
+    }
+}
+
+} // namespace who
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace who {
+
+enum class BandScale {
+    Log,
+    Mel,
+    Bark,
+    Erb,
+};
+
+struct BandLayout {
+    BandScale scale = BandScale::Log;
+    float min_frequency = 20.0f;
+    float max_frequency = 0.0f; // 0 selects Nyquist.
+};
+
+// Triangular filterbank over FFT bin powers, precomputed once and stored in
+// compressed sparse row form: each band reads one contiguous run of
+// (bin, weight) pairs. Weights in a band sum to one, so a band reports the
+// weighted mean power of the bins it covers.
+class Filterbank {
+public:
+    Filterbank() = default;
+    Filterbank(std::size_t bands, std::size_t fft_size, std::uint32_t sample_rate, const BandLayout& layout);
+
+    void apply(const float* bin_power, float* band_power) const;
+    float apply_band(std::size_t band, const float* bin_power) const;
+
+    std::size_t bands() const { return row_offsets_.empty() ? 0 : row_offsets_.size() - 1; }
+    // Lowest and highest bin with non-zero weight in a band.
+    std::size_t first_bin(std::size_t band) const { return bins_[row_offsets_[band]]; }
+    std::size_t last_bin(std::size_t band) const { return bins_[row_offsets_[band + 1] - 1]; }
+    float center_frequency(std::size_t band) const { return centers_[band]; }
+
+private:
+    std::vector<std::uint32_t> row_offsets_;
+    std::vector<std::uint32_t> bins_;
+    std::vector<float> weights_;
+    std::vector<float> centers_;
+};
+
+} // namespace who
@@ -0,0 +1,104 @@
+#include "frame_pacer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace who {
+
+namespace {
+constexpr std::size_t kSampleCount = 256;
+// Statistics and the adaptive rate are re-evaluated once per window.
+constexpr std::size_t kWindowFrames = 60;
+// Back off when the median render time uses this much of the frame budget or
+// more than a tenth of the window's slots were dropped...
+constexpr double kSlowFraction = 0.85;
+// ...and speed up again once even the p99 fits in this much of it.
+constexpr double kFastFraction = 0.5;
+constexpr double kBackoff = 0.8;
+constexpr double kRecover = 1.1;
+
+std::chrono::steady_clock::duration period_for(double fps) {
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / fps));
+}
+
+double percentile(std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const std::size_t index =
+        std::min(sorted.size() - 1, static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(sorted.size()))) - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(index), sorted.end());
+    return sorted[index];
+}
+} // namespace
+
+FramePacer::FramePacer(double target_fps, double min_fps, bool adaptive)
+    : target_fps_(target_fps > 0.0 ? target_fps : 60.0),
+      min_fps_(std::clamp(min_fps, 1.0, target_fps_)),
+      adaptive_(adaptive),
+      fps_(target_fps_),
+      period_(period_for(target_fps_)) {
+    samples_.reserve(kSampleCount);
+    stats_.fps = fps_;
+}
+
+void FramePacer::reset(Clock::time_point now) { deadline_ = now; }
+
+void FramePacer::resume(Clock::time_point now) {
+    if (now - deadline_ >= period_) {
+        deadline_ = now;
+    }
+}
+
+void FramePacer::frame_rendered(Clock::time_point start, Clock::time_point end, std::uint64_t bytes) {
+    const double render_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    if (samples_.size() < kSampleCount) {
+        samples_.push_back(render_ms);
+    } else {
+        samples_[next_sample_] = render_ms;
+    }
+    next_sample_ = (next_sample_ + 1) % kSampleCount;
+    ++stats_.frames_rendered;
+    window_bytes_ += bytes;
+
+    // Slots whose deadline passed while this frame was rendering are dropped.
+    const auto late = end - deadline_;
+    std::uint64_t skipped = 0;
+    if (late >= period_) {
+        skipped = static_cast<std::uint64_t>(late / period_);
+    }
+    stats_.frames_skipped += skipped;
+    window_skipped_ += skipped;
+    deadline_ += period_ * static_cast<Clock::rep>(skipped + 1);
+
+    if (++window_frames_ >= kWindowFrames) {
+        adapt();
+    }
+}
+
+void FramePacer::adapt() {
+    sorted_.assign(samples_.begin(), samples_.end());
+    stats_.render_p50_ms = percentile(sorted_, 0.5);
+    stats_.render_p99_ms = percentile(sorted_, 0.99);
+
+    if (adaptive_) {
+        const double budget_ms = 1000.0 / fps_;
+        double fps = fps_;
+        if (stats_.render_p50_ms > budget_ms * kSlowFraction || window_skipped_ * 10 > window_frames_) {
+            fps = std::max(min_fps_, fps_ * kBackoff);
+        } else if (stats_.render_p99_ms < budget_ms * kFastFraction && window_skipped_ == 0) {
+            fps = std::min(target_fps_, fps_ * kRecover);
+        }
+        if (fps != fps_) {
+            fps_ = fps;
+            period_ = period_for(fps_);
+        }
+    }
+    stats_.fps = fps_;
+    stats_.bytes_per_frame = static_cast<double>(window_bytes_) / static_cast<double>(window_frames_);
+    window_frames_ = 0;
+    window_skipped_ = 0;
+    window_bytes_ = 0;
+}
+
+} // namespace who
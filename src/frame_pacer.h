@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace who {
+
+struct FrameStats {
+    std::uint64_t frames_rendered = 0;
+    std::uint64_t frames_skipped = 0;
+    double render_p50_ms = 0.0;
+    double render_p99_ms = 0.0;
+    double fps = 0.0;
+    // Mean terminal output per frame over the last statistics window.
+    double bytes_per_frame = 0.0;
+};
+
+// Frame scheduling against absolute steady_clock deadlines: each deadline is
+// the previous one plus the frame period, so sleep overshoot never accumulates.
+// A frame that finishes past one or more later deadlines drops those slots
+// instead of rendering back-to-back to catch up. With adaptive pacing the
+// period is lengthened while render times exceed the budget and shortened
+// again, up to target_fps, once there is headroom.
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    FramePacer(double target_fps, double min_fps, bool adaptive);
+
+    void reset(Clock::time_point now);
+    // Re-anchors the schedule after the caller idled past its deadline, so
+    // the idle time is not counted as skipped frames.
+    void resume(Clock::time_point now);
+
+    Clock::time_point deadline() const { return deadline_; }
+
+    // Records a frame rendered between start and end that wrote `bytes` to
+    // the terminal, and schedules the next deadline.
+    void frame_rendered(Clock::time_point start, Clock::time_point end, std::uint64_t bytes = 0);
+
+    const FrameStats& stats() const { return stats_; }
+
+private:
+    void adapt();
+
+    double target_fps_;
+    double min_fps_;
+    bool adaptive_;
+    double fps_;
+    Clock::duration period_;
+    Clock::time_point deadline_{};
+
+    // Render times of the most recent frames, in milliseconds.
+    std::vector<double> samples_;
+    std::size_t next_sample_ = 0;
+    std::size_t window_frames_ = 0;
+    std::uint64_t window_skipped_ = 0;
+    std::uint64_t window_bytes_ = 0;
+    std::vector<double> sorted_;
+    FrameStats stats_{};
+};
+
+} // namespace who
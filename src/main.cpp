@@ -1,26 +1,136 @@
 #include <algorithm>
-#include <chrono>
-#include <cmath>
 #include <clocale>
 #include <cstdint>
+#include <cstdlib>
+#include <exception>
 #include <iostream>
+#include <memory>
+#include <set>
 #include <string>
 #include <thread>
 #include <vector>
 
 #include "audio_engine.h"
+#include "capture.h"
 #include "config.h"
 #include "dsp.h"
+#include "dsp_worker.h"
+#include "feature_file.h"
 #include "plugins.h"
+#include "render_worker.h"
 #include "renderer.h"
+#include "replay.h"
+#include "wakeup.h"
+
+namespace {
+
+// `who analyze [--config path] [-j threads] [--force] [-o out] inputs...`:
+// writes one feature file per input, next to it as <input>.whofeat unless -o
+// names the (single) output. Inputs whose feature file is current are skipped.
+int run_analyze(int argc, char** argv) {
+    std::string config_path = "who.toml";
+    std::string output_path;
+    std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    bool force = false;
+    std::vector<std::string> inputs;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if ((arg == "--config" || arg == "-c") && i + 1 < argc) {
+            config_path = argv[i + 1];
+            ++i;
+            continue;
+        }
+        if ((arg == "--output" || arg == "-o") && i + 1 < argc) {
+            output_path = argv[i + 1];
+            ++i;
+            continue;
+        }
+        if ((arg == "--jobs" || arg == "-j") && i + 1 < argc) {
+            threads = static_cast<std::size_t>(std::max(1L, std::strtol(argv[i + 1], nullptr, 10)));
+            ++i;
+            continue;
+        }
+        if (arg == "--force") {
+            force = true;
+            continue;
+        }
+        inputs.push_back(arg);
+    }
+    if (inputs.empty() || (!output_path.empty() && inputs.size() > 1)) {
+        std::cerr << "usage: who analyze [--config path] [-j threads] [--force] [-o output] input..." << std::endl;
+        std::cerr << "       (-o only with a single input)" << std::endl;
+        return 1;
+    }
+
+    const who::ConfigLoadResult config_result = who::load_app_config(config_path);
+    for (const std::string& warning : config_result.warnings) {
+        std::cerr << "[config] " << warning << std::endl;
+    }
+    const who::AppConfig& config = config_result.config;
+
+    std::vector<who::AnalysisJob> jobs;
+    std::set<std::string> outputs;
+    for (const std::string& input : inputs) {
+        who::AnalysisJob job{input, output_path.empty() ? input + ".whofeat" : output_path};
+        // Two jobs writing the same output would race on its temporary file.
+        if (outputs.insert(job.output).second) {
+            jobs.push_back(std::move(job));
+        }
+    }
+
+    const auto report = [](const who::AnalysisJob& job,
+                           const who::AnalysisOutcome& outcome,
+                           const who::BatchProgress& progress) {
+        std::ostream& out = outcome.status == who::AnalysisStatus::Failed ? std::cerr : std::clog;
+        out << "[analyze] " << progress.completed << "/" << progress.total << " " << job.input;
+        switch (outcome.status) {
+        case who::AnalysisStatus::Analyzed:
+            out << ": " << outcome.summary.hops << " hops, " << outcome.summary.audio_seconds << " s";
+            break;
+        case who::AnalysisStatus::Skipped:
+            out << ": up to date";
+            break;
+        case who::AnalysisStatus::Failed:
+            out << ": " << outcome.error;
+            break;
+        }
+        const double elapsed_s = std::max(progress.elapsed_s, 1e-9);
+        out << " (" << static_cast<double>(progress.completed) / elapsed_s << " files/s, "
+            << progress.audio_seconds / elapsed_s << " audio-s/s)" << std::endl;
+    };
+    const std::vector<who::AnalysisOutcome> outcomes = who::analyze_batch(
+        jobs, config.audio.capture.sample_rate, who::make_dsp_options(config.dsp), threads, force, report);
+
+    std::size_t analyzed = 0;
+    std::size_t skipped = 0;
+    std::size_t failed = 0;
+    for (const who::AnalysisOutcome& outcome : outcomes) {
+        analyzed += outcome.status == who::AnalysisStatus::Analyzed;
+        skipped += outcome.status == who::AnalysisStatus::Skipped;
+        failed += outcome.status == who::AnalysisStatus::Failed;
+    }
+    std::clog << "[analyze] " << analyzed << " analysed, " << skipped << " up to date, " << failed << " failed on "
+              << who::analysis_threads(threads, jobs.size()) << " threads" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
+
+} // namespace
 
 int main(int argc, char** argv) {
     std::setlocale(LC_ALL, "");
 
+    if (argc >= 2 && std::string(argv[1]) == "analyze") {
+        return run_analyze(argc, argv);
+    }
+
     std::string config_path = "who.toml";
     std::string file_path;
     std::string device_name_override;
+    std::string record_path;
+    std::string replay_path;
+    std::string features_path;
     int system_override = -1; // -1 = use config, 0 = mic, 1 = system
+    bool fast_file = false;
     for (int i = 1; i < argc; ++i) {
         const std::string arg = argv[i];
         if ((arg == "--config" || arg == "-c") && i + 1 < argc) {
@@ -38,6 +148,21 @@ int main(int argc, char** argv) {
             ++i;
             continue;
         }
+        if (arg == "--record" && i + 1 < argc) {
+            record_path = argv[i + 1];
+            ++i;
+            continue;
+        }
+        if (arg == "--replay" && i + 1 < argc) {
+            replay_path = argv[i + 1];
+            ++i;
+            continue;
+        }
+        if (arg == "--features" && i + 1 < argc) {
+            features_path = argv[i + 1];
+            ++i;
+            continue;
+        }
         if (arg == "--system") {
             system_override = 1;
             continue;
@@ -46,6 +171,10 @@ int main(int argc, char** argv) {
             system_override = 0;
             continue;
         }
+        if (arg == "--fast") {
+            fast_file = true;
+            continue;
+        }
     }
 
     const who::ConfigLoadResult config_result = who::load_app_config(config_path);
@@ -59,6 +188,61 @@ int main(int argc, char** argv) {
         std::cerr << "[config] " << warning << std::endl;
     }
 
+    // Playback only needs the terminal: no audio, DSP or plugins.
+    if (!replay_path.empty()) {
+        std::unique_ptr<who::CaptureReader> reader;
+        try {
+            reader = std::make_unique<who::CaptureReader>(replay_path);
+        } catch (const std::exception& error) {
+            std::cerr << "[replay] " << error.what() << std::endl;
+            return 1;
+        }
+        notcurses_options opts{};
+        opts.flags = NCOPTION_SUPPRESS_BANNERS;
+        notcurses* nc = notcurses_init(&opts, nullptr);
+        if (!nc) {
+            std::cerr << "Failed to initialize notcurses" << std::endl;
+            return 1;
+        }
+        std::string replay_error;
+        try {
+            who::replay_capture(nc, *reader);
+        } catch (const std::exception& error) {
+            replay_error = error.what();
+        }
+        if (notcurses_stop(nc) != 0) {
+            std::cerr << "Failed to stop notcurses cleanly" << std::endl;
+            return 1;
+        }
+        if (!replay_error.empty()) {
+            std::cerr << "[replay] " << replay_error << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // Opened before anything starts so a bad path fails fast.
+    std::unique_ptr<who::CaptureWriter> capture;
+    if (!record_path.empty()) {
+        try {
+            capture = std::make_unique<who::CaptureWriter>(record_path);
+        } catch (const std::exception& error) {
+            std::cerr << "[record] " << error.what() << std::endl;
+            return 1;
+        }
+    }
+
+    // Precomputed analysis replaces audio input and DSP entirely.
+    std::unique_ptr<who::FeatureFile> features;
+    if (!features_path.empty()) {
+        try {
+            features = std::make_unique<who::FeatureFile>(features_path);
+        } catch (const std::exception& error) {
+            std::cerr << "[features] " << error.what() << std::endl;
+            return 1;
+        }
+    }
+
     if (file_path.empty() && config.audio.prefer_file && config.audio.file.enabled && !config.audio.file.path.empty()) {
         file_path = config.audio.file.path;
     }
@@ -82,14 +266,21 @@ int main(int argc, char** argv) {
     }
     const std::size_t ring_frames = std::max<std::size_t>(1024, config.audio.capture.ring_frames);
 
+    who::FileStreamOptions file_options;
+    file_options.pacing = fast_file ? who::FilePacing::Fast : config.audio.file.pacing;
+    file_options.decode_ahead_s = config.audio.file.decode_ahead;
     who::AudioEngine audio(sample_rate,
                            channels,
                            ring_frames,
                            use_file_stream ? file_path : std::string{},
                            capture_device,
-                           use_system_audio);
+                           use_system_audio,
+                           file_options);
     bool audio_active = false;
-    if (use_file_stream || config.audio.capture.enabled) {
+    if (features && !use_file_stream) {
+        std::clog << "[features] playing '" << features_path
+                  << "' on its own clock from launch; add --file with the analysed audio to follow it" << std::endl;
+    } else if (use_file_stream || config.audio.capture.enabled) {
         audio_active = audio.start();
         if (!audio_active) {
             std::cerr << "[audio] failed to start audio backend";
@@ -101,12 +292,36 @@ int main(int argc, char** argv) {
     } else {
         std::clog << "[audio] capture disabled; running without live audio" << std::endl;
     }
+    // The feature tracks follow the streamed file in place of the DSP worker.
+    const bool follow_audio = features && use_file_stream && audio_active;
+    if (follow_audio) {
+        std::clog << "[features] following '" << file_path << "' with '" << features_path << "'" << std::endl;
+        try {
+            if (who::hash_file(file_path) != features->header().source_hash) {
+                std::cerr << "[features] '" << features_path << "' was analysed from different audio" << std::endl;
+            }
+        } catch (const std::exception&) {
+            // The stream itself already opened the file; a failed re-read only
+            // skips the check.
+        }
+    }
 
-    who::DspEngine dsp(sample_rate,
-                       channels,
-                       config.dsp.fft_size,
-                       config.dsp.hop_size,
-                       config.dsp.bands);
+    // Signalled by the analysis source and the input loop whenever a new frame is
+    // worth drawing.
+    who::Wakeup frame_wakeup;
+    const std::size_t batch_samples = std::max<std::size_t>(4096, ring_frames * static_cast<std::size_t>(channels));
+    who::DspWorker dsp_worker(audio,
+                              std::make_unique<who::DspEngine>(sample_rate, channels, who::make_dsp_options(config.dsp)),
+                              batch_samples,
+                              &frame_wakeup,
+                              config.runtime.idle_after);
+    std::unique_ptr<who::FeaturePlayer> feature_player;
+    if (features) {
+        feature_player =
+            std::make_unique<who::FeaturePlayer>(*features, &frame_wakeup, follow_audio ? &audio : nullptr);
+    }
+    who::AnalysisSource& analysis =
+        feature_player ? static_cast<who::AnalysisSource&>(*feature_player) : dsp_worker;
 
     who::PluginManager plugin_manager;
     who::register_builtin_plugins(plugin_manager);
@@ -124,160 +339,201 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    int grid_rows = config.visual.grid.rows;
-    int grid_cols = config.visual.grid.cols;
+    if (feature_player) {
+        feature_player->start();
+    } else if (audio_active) {
+        dsp_worker.start();
+    }
+
     const int min_grid_dim = config.visual.grid.min_dim;
     const int max_grid_dim = config.visual.grid.max_dim;
-    float sensitivity = config.visual.sensitivity.value;
     const float min_sensitivity = config.visual.sensitivity.min_value;
     const float max_sensitivity = config.visual.sensitivity.max_value;
     const float sensitivity_step = config.visual.sensitivity.step;
-    who::VisualizationMode mode = config.visual.default_mode;
-    who::ColorPalette palette = config.visual.default_palette;
-    const std::chrono::duration<double> frame_time(1.0 / config.visual.target_fps);
-
-    const std::size_t scratch_samples = std::max<std::size_t>(4096, ring_frames * static_cast<std::size_t>(channels));
-    std::vector<float> audio_scratch(scratch_samples);
-    who::AudioMetrics audio_metrics{};
-    audio_metrics.active = audio_active;
-
-    bool running = true;
-    const auto start_time = std::chrono::steady_clock::now();
-
-    while (running) {
-        const auto now = std::chrono::steady_clock::now();
-        const auto elapsed = now - start_time;
-        const float time_s = std::chrono::duration_cast<std::chrono::duration<float>>(elapsed).count();
-
-        if (audio_active) {
-            const std::size_t samples_read = audio.read_samples(audio_scratch.data(), audio_scratch.size());
-            if (samples_read > 0) {
-                dsp.push_samples(audio_scratch.data(), samples_read);
-                double sum_squares = 0.0;
-                float peak_value = 0.0f;
-                for (std::size_t i = 0; i < samples_read; ++i) {
-                    const float sample = audio_scratch[i];
-                    sum_squares += static_cast<double>(sample) * static_cast<double>(sample);
-                    peak_value = std::max(peak_value, std::abs(sample));
-                }
-                const float rms_instant = std::sqrt(sum_squares / static_cast<double>(samples_read));
-                audio_metrics.rms = audio_metrics.rms * 0.9f + rms_instant * 0.1f;
-                audio_metrics.peak = std::max(peak_value, audio_metrics.peak * 0.95f);
-            } else {
-                audio_metrics.rms *= 0.98f;
-                audio_metrics.peak *= 0.98f;
-            }
-            audio_metrics.dropped = audio.dropped_samples();
-        }
-
-        plugin_manager.notify_frame(audio_metrics, dsp.band_energies(), dsp.beat_strength(), time_s);
-
-        who::draw_grid(nc,
-                       grid_rows,
-                       grid_cols,
-                       time_s,
-                       mode,
-                       palette,
-                       sensitivity,
-                       audio_metrics,
-                       dsp.band_energies(),
-                       dsp.beat_strength(),
-                       audio.using_file_stream(),
-                       config.runtime.show_metrics,
-                       config.runtime.show_overlay_metrics);
-
-        if (notcurses_render(nc) != 0) {
-            std::cerr << "Failed to render frame" << std::endl;
-            break;
+
+    std::vector<who::PaneSpec> panes;
+    for (const who::PaneConfig& pane_config : config.visual.panes) {
+        who::PaneSpec spec;
+        spec.view.grid_rows = pane_config.rows;
+        spec.view.grid_cols = pane_config.cols;
+        spec.view.mode = pane_config.mode;
+        spec.view.palette = pane_config.palette;
+        spec.view.blitter = pane_config.blitter;
+        spec.view.sensitivity = pane_config.sensitivity;
+        spec.metrics = pane_config.metrics;
+        spec.frame_divisor = pane_config.frame_divisor;
+        spec.weight = pane_config.weight;
+        panes.push_back(spec);
+    }
+    if (panes.empty()) {
+        who::PaneSpec spec;
+        spec.view.grid_rows = config.visual.grid.rows;
+        spec.view.grid_cols = config.visual.grid.cols;
+        spec.view.mode = config.visual.default_mode;
+        spec.view.palette = config.visual.default_palette;
+        spec.view.blitter = config.visual.default_blitter;
+        spec.view.sensitivity = config.visual.sensitivity.value;
+        panes.push_back(spec);
+    }
+    // The input loop's copy of each pane's settings; keys edit the focused
+    // grid pane, Tab moves the focus.
+    std::vector<who::ViewSettings> views;
+    std::vector<std::size_t> grid_panes;
+    for (std::size_t i = 0; i < panes.size(); ++i) {
+        views.push_back(panes[i].view);
+        if (!panes[i].metrics) {
+            grid_panes.push_back(i);
         }
+    }
+    std::size_t focus_slot = 0;
 
+    who::RenderOptions render_options;
+    render_options.target_fps = config.visual.target_fps;
+    render_options.min_fps = config.visual.min_fps;
+    render_options.adaptive_fps = config.visual.adaptive_fps;
+    render_options.file_stream = audio.using_file_stream() || features != nullptr;
+    render_options.show_metrics = config.runtime.show_metrics;
+    render_options.show_overlay_metrics = config.runtime.show_overlay_metrics;
+    render_options.render_threads = config.visual.render_threads;
+
+    // Panes own notcurses planes, so the worker must be gone before
+    // notcurses_stop.
+    auto render_worker = std::make_unique<who::RenderWorker>(
+        nc, analysis, plugin_manager, render_options, panes, frame_wakeup, capture.get());
+    render_worker->start();
+
+    // Input is handled here while frames are drawn on the render thread; the
+    // timeout only bounds how quickly a render failure is noticed.
+    constexpr long kInputPollNanoseconds = 50'000'000;
+    const timespec input_timeout{0, kInputPollNanoseconds};
+    while (!render_worker->failed()) {
         ncinput input{};
-        const timespec ts{0, 0};
-        uint32_t key = 0;
-        while ((key = notcurses_get(nc, &ts, &input)) != 0) {
-            if (key == static_cast<uint32_t>(-1)) {
-                running = false;
+        const uint32_t key = notcurses_get(nc, &input_timeout, &input);
+        if (key == 0) {
+            continue;
+        }
+        if (key == static_cast<uint32_t>(-1) || key == 'q' || key == 'Q') {
+            break;
+        }
+        if (key == NCKEY_RESIZE) {
+            render_worker->request_frame();
+            continue;
+        }
+        if (grid_panes.empty()) {
+            continue;
+        }
+        if (key == NCKEY_TAB) {
+            focus_slot = (focus_slot + 1) % grid_panes.size();
+            render_worker->set_focus(grid_panes[focus_slot]);
+            continue;
+        }
+        const std::size_t focus = grid_panes[focus_slot];
+        who::ViewSettings& view = views[focus];
+        if (config.runtime.allow_resize && key == NCKEY_UP) {
+            view.grid_rows = std::min(view.grid_rows + 1, max_grid_dim);
+            render_worker->update_settings(focus, view);
+            continue;
+        }
+        if (config.runtime.allow_resize && key == NCKEY_DOWN) {
+            view.grid_rows = std::max(view.grid_rows - 1, min_grid_dim);
+            render_worker->update_settings(focus, view);
+            continue;
+        }
+        if (config.runtime.allow_resize && key == NCKEY_RIGHT) {
+            view.grid_cols = std::min(view.grid_cols + 1, max_grid_dim);
+            render_worker->update_settings(focus, view);
+            continue;
+        }
+        if (config.runtime.allow_resize && key == NCKEY_LEFT) {
+            view.grid_cols = std::max(view.grid_cols - 1, min_grid_dim);
+            render_worker->update_settings(focus, view);
+            continue;
+        }
+        if (key == 'm' || key == 'M') {
+            switch (view.mode) {
+            case who::VisualizationMode::Bands:
+                view.mode = who::VisualizationMode::Radial;
                 break;
-            }
-            if (key == 'q' || key == 'Q') {
-                running = false;
+            case who::VisualizationMode::Radial:
+                view.mode = who::VisualizationMode::Trails;
+                break;
+            case who::VisualizationMode::Trails:
+                view.mode = who::VisualizationMode::Digital;
+                break;
+            case who::VisualizationMode::Digital:
+                view.mode = who::VisualizationMode::Ascii;
+                break;
+            case who::VisualizationMode::Ascii:
+                view.mode = who::VisualizationMode::Bands;
                 break;
             }
-            if (config.runtime.allow_resize && key == NCKEY_UP) {
-                grid_rows = std::min(grid_rows + 1, max_grid_dim);
-                continue;
-            }
-            if (config.runtime.allow_resize && key == NCKEY_DOWN) {
-                grid_rows = std::max(grid_rows - 1, min_grid_dim);
-                continue;
-            }
-            if (config.runtime.allow_resize && key == NCKEY_RIGHT) {
-                grid_cols = std::min(grid_cols + 1, max_grid_dim);
-                continue;
-            }
-            if (config.runtime.allow_resize && key == NCKEY_LEFT) {
-                grid_cols = std::max(grid_cols - 1, min_grid_dim);
-                continue;
-            }
-            if (key == 'm' || key == 'M') {
-                switch (mode) {
-                case who::VisualizationMode::Bands:
-                    mode = who::VisualizationMode::Radial;
-                    break;
-                case who::VisualizationMode::Radial:
-                    mode = who::VisualizationMode::Trails;
-                    break;
-                case who::VisualizationMode::Trails:
-                    mode = who::VisualizationMode::Digital;
-                    break;
-                case who::VisualizationMode::Digital:
-                    mode = who::VisualizationMode::Ascii;
-                    break;
-                case who::VisualizationMode::Ascii:
-                    mode = who::VisualizationMode::Bands;
-                    break;
-                }
-                continue;
-            }
-            if (key == 'p' || key == 'P') {
-                switch (palette) {
-                case who::ColorPalette::Rainbow:
-                    palette = who::ColorPalette::WarmCool;
-                    break;
-                case who::ColorPalette::WarmCool:
-                    palette = who::ColorPalette::DigitalAmber;
-                    break;
-                case who::ColorPalette::DigitalAmber:
-                    palette = who::ColorPalette::DigitalCyan;
-                    break;
-                case who::ColorPalette::DigitalCyan:
-                    palette = who::ColorPalette::DigitalViolet;
-                    break;
-                case who::ColorPalette::DigitalViolet:
-                    palette = who::ColorPalette::Rainbow;
-                    break;
-                }
-                continue;
-            }
-            if (key == '[') {
-                sensitivity = std::max(min_sensitivity, sensitivity - sensitivity_step);
-                continue;
-            }
-            if (key == ']') {
-                sensitivity = std::min(max_sensitivity, sensitivity + sensitivity_step);
-                continue;
+            render_worker->update_settings(focus, view);
+            continue;
+        }
+        if (key == 'b' || key == 'B') {
+            switch (view.blitter) {
+            case who::GridBlitter::Solid:
+                view.blitter = who::GridBlitter::HalfBlock;
+                break;
+            case who::GridBlitter::HalfBlock:
+                view.blitter = who::GridBlitter::Quadrant;
+                break;
+            case who::GridBlitter::Quadrant:
+                view.blitter = who::GridBlitter::Sextant;
+                break;
+            case who::GridBlitter::Sextant:
+                view.blitter = who::GridBlitter::Braille;
+                break;
+            case who::GridBlitter::Braille:
+                view.blitter = who::GridBlitter::Pixel;
+                break;
+            case who::GridBlitter::Pixel:
+                view.blitter = who::GridBlitter::Solid;
+                break;
             }
-            if (key == NCKEY_RESIZE) {
+            render_worker->update_settings(focus, view);
+            continue;
+        }
+        if (key == 'p' || key == 'P') {
+            switch (view.palette) {
+            case who::ColorPalette::Rainbow:
+                view.palette = who::ColorPalette::WarmCool;
+                break;
+            case who::ColorPalette::WarmCool:
+                view.palette = who::ColorPalette::DigitalAmber;
+                break;
+            case who::ColorPalette::DigitalAmber:
+                view.palette = who::ColorPalette::DigitalCyan;
+                break;
+            case who::ColorPalette::DigitalCyan:
+                view.palette = who::ColorPalette::DigitalViolet;
+                break;
+            case who::ColorPalette::DigitalViolet:
+                view.palette = who::ColorPalette::Rainbow;
                 break;
             }
+            render_worker->update_settings(focus, view);
+            continue;
         }
-
-        const auto frame_end = std::chrono::steady_clock::now();
-        if (frame_end - now < frame_time) {
-            std::this_thread::sleep_for(frame_time - (frame_end - now));
+        if (key == '[') {
+            view.sensitivity = std::max(min_sensitivity, view.sensitivity - sensitivity_step);
+            render_worker->update_settings(focus, view);
+            continue;
+        }
+        if (key == ']') {
+            view.sensitivity = std::min(max_sensitivity, view.sensitivity + sensitivity_step);
+            render_worker->update_settings(focus, view);
+            continue;
         }
     }
 
+    render_worker.reset();
+    // Finishes the capture file with its index.
+    capture.reset();
+    if (feature_player) {
+        feature_player->stop();
+    }
+    dsp_worker.stop();
     audio.stop();
 
     if (notcurses_stop(nc) != 0) {
@@ -0,0 +1,226 @@
+#include "memory_backend.h"
+
+#include <algorithm>
+
+namespace who {
+namespace {
+
+std::size_t decimal_digits(unsigned int value) {
+    std::size_t digits = 1;
+    while (value >= 10) {
+        value /= 10;
+        ++digits;
+    }
+    return digits;
+}
+
+// "\x1b[38;2;R;G;Bm" or "\x1b[39m" (48/49 for the background).
+std::size_t sgr_bytes(Rgb color, bool is_default) {
+    if (is_default) {
+        return 5;
+    }
+    return 7 + decimal_digits(color.r) + 1 + decimal_digits(color.g) + 1 + decimal_digits(color.b) + 1;
+}
+
+std::size_t utf8_bytes(char32_t glyph) {
+    if (glyph < 0x80) {
+        return 1;
+    }
+    if (glyph < 0x800) {
+        return 2;
+    }
+    if (glyph < 0x10000) {
+        return 3;
+    }
+    return 4;
+}
+
+bool same_color(Rgb a, Rgb b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+// NotcursesBackend::cells() writes each run of equally styled sub-cells as
+// one string.
+bool same_style(const SubCell& a, const SubCell& b) {
+    return a.has_background == b.has_background && same_color(a.foreground, b.foreground) &&
+           (!a.has_background || same_color(a.background, b.background));
+}
+
+} // namespace
+
+MemoryBackend::MemoryBackend(unsigned int rows, unsigned int cols, CellPixels pixels)
+    : rows_(rows), cols_(cols), cells_(static_cast<std::size_t>(rows) * cols), pixels_(pixels) {}
+
+void MemoryBackend::resize(unsigned int rows, unsigned int cols) {
+    std::vector<Cell> cells(static_cast<std::size_t>(rows) * cols);
+    for (unsigned int y = 0; y < std::min(rows, rows_); ++y) {
+        const auto row = cells_.begin() + static_cast<std::ptrdiff_t>(static_cast<std::size_t>(y) * cols_);
+        std::copy(row, row + std::min(cols, cols_), cells.begin() + static_cast<std::ptrdiff_t>(static_cast<std::size_t>(y) * cols));
+    }
+    cells_.swap(cells);
+    rows_ = rows;
+    cols_ = cols;
+    cursor_y_ = -1;
+    cursor_x_ = -1;
+}
+
+void MemoryBackend::erase() {
+    ++counters_.calls;
+    ++counters_.writes;
+    counters_.bytes += 4; // "\x1b[2J"
+    std::fill(cells_.begin(), cells_.end(), Cell{});
+}
+
+MemoryBackend::Cell* MemoryBackend::clip(int y, int& x, int& width) {
+    if (y < 0 || y >= static_cast<int>(rows_)) {
+        return nullptr;
+    }
+    if (x < 0) {
+        width += x;
+        x = 0;
+    }
+    width = std::min(width, static_cast<int>(cols_) - x);
+    if (width <= 0) {
+        return nullptr;
+    }
+    counters_.cells += static_cast<std::size_t>(width);
+    return &cells_[static_cast<std::size_t>(y) * cols_ + static_cast<std::size_t>(x)];
+}
+
+void MemoryBackend::emit(int y, int x, const Cell& cell) {
+    if (y != cursor_y_ || x != cursor_x_) {
+        // "\x1b[Y;XH"
+        counters_.bytes += 4 + decimal_digits(static_cast<unsigned int>(y + 1)) +
+                           decimal_digits(static_cast<unsigned int>(x + 1));
+    }
+    // A blank cell only shows its background, so its foreground never forces
+    // an SGR change.
+    if (cell.glyph != U' ' &&
+        (cell.default_foreground != style_.default_foreground ||
+         (!cell.default_foreground && !same_color(cell.foreground, style_.foreground)))) {
+        counters_.bytes += sgr_bytes(cell.foreground, cell.default_foreground);
+        style_.foreground = cell.foreground;
+        style_.default_foreground = cell.default_foreground;
+    }
+    if (cell.default_background != style_.default_background ||
+        (!cell.default_background && !same_color(cell.background, style_.background))) {
+        counters_.bytes += sgr_bytes(cell.background, cell.default_background);
+        style_.background = cell.background;
+        style_.default_background = cell.default_background;
+    }
+    counters_.bytes += utf8_bytes(cell.glyph);
+    cursor_y_ = y;
+    cursor_x_ = x + 1;
+}
+
+void MemoryBackend::fill(int y, int x, int width, int count, int stride, Rgb background) {
+    ++counters_.calls;
+    if (width <= 0 || count <= 0) {
+        return;
+    }
+    ++counters_.writes;
+    // Same encoding as NotcursesBackend: background-coloured blanks for one
+    // contiguous stretch, otherwise full blocks with default-background gutters.
+    const Cell value = count == 1 || stride == width ? Cell{U' ', Rgb{0, 0, 0}, background, true, false}
+                                       : Cell{U'\u2588', background, Rgb{0, 0, 0}, false, true};
+    for (int i = 0; i < count; ++i) {
+        int span_x = x + i * stride;
+        int span_width = i + 1 < count ? stride : width;
+        Cell* cells = clip(y, span_x, span_width);
+        for (int j = 0; cells && j < span_width; ++j) {
+            cells[j] = span_x + j - (x + i * stride) < width ? value : Cell{};
+            emit(y, span_x + j, cells[j]);
+        }
+    }
+}
+
+void MemoryBackend::glyphs(int y, int x, int width, char glyph, Rgb foreground) {
+    ++counters_.calls;
+    ++counters_.writes;
+    const Cell value{static_cast<char32_t>(static_cast<unsigned char>(glyph)), foreground, Rgb{0, 0, 0}, false, true};
+    Cell* cells = clip(y, x, width);
+    for (int i = 0; cells && i < width; ++i) {
+        cells[i] = value;
+        emit(y, x + i, value);
+    }
+}
+
+void MemoryBackend::cells(int y, int x, const SubCell* cells, int count) {
+    ++counters_.calls;
+    for (int i = 0; i < count; ++i) {
+        if (i == 0 || !same_style(cells[i], cells[i - 1])) {
+            ++counters_.writes;
+        }
+    }
+    const int first = x;
+    Cell* out = clip(y, x, count);
+    for (int i = 0; out && i < count; ++i) {
+        const SubCell& in = cells[x - first + i];
+        out[i] = Cell{in.glyph, in.foreground, in.background, false, !in.has_background};
+        emit(y, x + i, out[i]);
+    }
+}
+
+void MemoryBackend::text(int y, int x, Rgb foreground, std::string_view text) {
+    ++counters_.calls;
+    ++counters_.writes;
+    int width = static_cast<int>(text.size());
+    const int first = x;
+    Cell* cells = clip(y, x, width);
+    for (int i = 0; cells && i < width; ++i) {
+        const char glyph = text[static_cast<std::size_t>(x - first + i)];
+        cells[i] = Cell{static_cast<char32_t>(static_cast<unsigned char>(glyph)), foreground, Rgb{0, 0, 0}, false, true};
+        emit(y, x + i, cells[i]);
+    }
+}
+
+void MemoryBackend::clear(int y, int x, int width) {
+    ++counters_.calls;
+    ++counters_.writes;
+    Cell* cells = clip(y, x, width);
+    for (int i = 0; cells && i < width; ++i) {
+        cells[i] = Cell{};
+        emit(y, x + i, cells[i]);
+    }
+}
+
+void MemoryBackend::image(int y, int x, int rows, int cols, const std::uint32_t* rgba, int width, int height,
+                          const std::uint8_t* dirty_rows) {
+    ++counters_.calls;
+    const std::size_t count = static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+    // Like NotcursesBackend, only bands holding a dirty row go out again.
+    const bool moved = image_.size() != count || y != image_y_ || x != image_x_ || rows != image_rows_ ||
+                       cols != image_cols_;
+    for (int top = 0; top < rows; top += kImageBandRows) {
+        const int bottom = std::min(rows, top + kImageBandRows);
+        if (!moved && dirty_rows && std::none_of(dirty_rows + top, dirty_rows + bottom, [](std::uint8_t row) {
+                return row != 0;
+            })) {
+            continue;
+        }
+        const long long band_height = static_cast<long long>(bottom) * height / rows -
+                                      static_cast<long long>(top) * height / rows;
+        const std::size_t band_pixels = static_cast<std::size_t>(width) * static_cast<std::size_t>(band_height);
+        ++counters_.writes;
+        counters_.cells += static_cast<std::size_t>(bottom - top) * static_cast<std::size_t>(std::max(0, cols));
+        counters_.bytes += (band_pixels * 4 + 2) / 3 * 4;
+    }
+    image_.assign(rgba, rgba + count);
+    image_y_ = y;
+    image_x_ = x;
+    image_rows_ = rows;
+    image_cols_ = cols;
+    // The terminal parks the cursor after the image.
+    cursor_y_ = -1;
+    cursor_x_ = -1;
+}
+
+void MemoryBackend::clear_image() {
+    if (image_.empty()) {
+        return;
+    }
+    ++counters_.calls;
+    image_.clear();
+}
+
+} // namespace who
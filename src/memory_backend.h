@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "render_backend.h"
+
+namespace who {
+
+// In-memory framebuffer for headless rendering, benchmarks and frame
+// comparisons. Counts how much output a real terminal backend would receive.
+class MemoryBackend final : public RenderBackend {
+public:
+    struct Cell {
+        char32_t glyph = U' ';
+        Rgb foreground{0, 0, 0};
+        Rgb background{0, 0, 0};
+        bool default_foreground = true;
+        bool default_background = true;
+    };
+
+    struct Counters {
+        std::size_t calls = 0; // erase/fill/glyphs/cells/text/clear/image invocations
+        // Writes NotcursesBackend issues for the same output: one per
+        // ncplane_erase(), ncplane_putstr*() and ncvisual_blit().
+        std::size_t writes = 0;
+        std::size_t cells = 0; // terminal cells written
+        // Estimated bytes a plain escape-sequence emitter would send: cursor
+        // moves when output is not contiguous, 24-bit SGR only on colour
+        // changes, and UTF-8 glyphs. Bitmaps count as base64-encoded RGBA,
+        // as the kitty graphics protocol sends them.
+        std::size_t bytes = 0;
+    };
+
+    // A non-zero `pixels` lets the surface accept bitmaps at that cell size.
+    MemoryBackend(unsigned int rows, unsigned int cols, CellPixels pixels = {});
+
+    unsigned int rows() const override { return rows_; }
+    unsigned int cols() const override { return cols_; }
+
+    void erase() override;
+    void fill(int y, int x, int width, int count, int stride, Rgb background) override;
+    void glyphs(int y, int x, int width, char glyph, Rgb foreground) override;
+    void cells(int y, int x, const SubCell* cells, int count) override;
+    void text(int y, int x, Rgb foreground, std::string_view text) override;
+    void clear(int y, int x, int width) override;
+
+    CellPixels cell_pixels() const override { return pixels_; }
+    void image(int y, int x, int rows, int cols, const std::uint32_t* rgba, int width, int height,
+               const std::uint8_t* dirty_rows) override;
+    void clear_image() override;
+
+    // Keeps the overlapping top-left region, like ncplane_resize_simple().
+    void resize(unsigned int rows, unsigned int cols);
+    const Cell& at(int y, int x) const { return cells_[static_cast<std::size_t>(y) * cols_ + static_cast<std::size_t>(x)]; }
+    // The last bitmap shown, empty when there is none.
+    const std::vector<std::uint32_t>& image_pixels() const { return image_; }
+    const Counters& counters() const { return counters_; }
+    void reset_counters() { counters_ = {}; }
+
+private:
+    // Clips [x, x + width) on row y to the surface; returns the first cell or
+    // nullptr when nothing is visible.
+    Cell* clip(int y, int& x, int& width);
+    // Accounts one visible cell write at (y, x) for the byte estimate.
+    void emit(int y, int x, const Cell& cell);
+
+    unsigned int rows_;
+    unsigned int cols_;
+    std::vector<Cell> cells_;
+    CellPixels pixels_;
+    std::vector<std::uint32_t> image_;
+    int image_y_ = 0;
+    int image_x_ = 0;
+    int image_rows_ = 0;
+    int image_cols_ = 0;
+    Counters counters_;
+
+    int cursor_y_ = -1;
+    int cursor_x_ = -1;
+    Cell style_;
+};
+
+} // namespace who
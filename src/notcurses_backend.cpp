@@ -0,0 +1,212 @@
+#include "notcurses_backend.h"
+
+#include <algorithm>
+
+namespace who {
+namespace {
+
+bool same_color(Rgb a, Rgb b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+void append_utf8(std::string& out, char32_t glyph) {
+    if (glyph < 0x80) {
+        out.push_back(static_cast<char>(glyph));
+    } else if (glyph < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (glyph >> 6)));
+        out.push_back(static_cast<char>(0x80 | (glyph & 0x3F)));
+    } else if (glyph < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (glyph >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((glyph >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (glyph & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (glyph >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((glyph >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((glyph >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (glyph & 0x3F)));
+    }
+}
+
+} // namespace
+
+NotcursesBackend::NotcursesBackend(ncplane* plane)
+    : plane_(plane), pixel_support_(notcurses_check_pixel_support(ncplane_notcurses(plane)) > 0) {}
+
+NotcursesBackend::~NotcursesBackend() { clear_image(); }
+
+unsigned int NotcursesBackend::rows() const {
+    unsigned int rows = 0;
+    unsigned int cols = 0;
+    ncplane_dim_yx(plane_, &rows, &cols);
+    return rows;
+}
+
+unsigned int NotcursesBackend::cols() const {
+    unsigned int rows = 0;
+    unsigned int cols = 0;
+    ncplane_dim_yx(plane_, &rows, &cols);
+    return cols;
+}
+
+void NotcursesBackend::erase() {
+    ncplane_erase(plane_);
+}
+
+void NotcursesBackend::fill(int y, int x, int width, int count, int stride, Rgb background) {
+    if (width <= 0 || count <= 0) {
+        return;
+    }
+    if (count == 1 || stride == width) {
+        ncplane_set_fg_default(plane_);
+        ncplane_set_bg_rgb8(plane_, background.r, background.g, background.b);
+        ncplane_putstr_yx(plane_, y, x, run(width * count, ' ').c_str());
+        return;
+    }
+    // A putstr carries a single style, so several spans and the
+    // default-background gutters between them go out together as full
+    // blocks and spaces. Blocks cost three bytes a cell, so a lone span stays
+    // a blank run.
+    run_.clear();
+    for (int i = 0; i < count; ++i) {
+        for (int j = 0; j < width; ++j) {
+            append_utf8(run_, U'\u2588');
+        }
+        if (i + 1 < count) {
+            run_.append(static_cast<std::size_t>(stride - width), ' ');
+        }
+    }
+    ncplane_set_fg_rgb8(plane_, background.r, background.g, background.b);
+    ncplane_set_bg_default(plane_);
+    ncplane_putstr_yx(plane_, y, x, run_.c_str());
+}
+
+void NotcursesBackend::glyphs(int y, int x, int width, char glyph, Rgb foreground) {
+    if (width <= 0) {
+        return;
+    }
+    ncplane_set_bg_default(plane_);
+    ncplane_set_fg_rgb8(plane_, foreground.r, foreground.g, foreground.b);
+    ncplane_putstr_yx(plane_, y, x, run(width, glyph).c_str());
+}
+
+void NotcursesBackend::cells(int y, int x, const SubCell* cells, int count) {
+    int i = 0;
+    while (i < count) {
+        // Cells sharing a style go out as one UTF-8 string.
+        const SubCell& first = cells[i];
+        run_.clear();
+        int end = i;
+        while (end < count && cells[end].has_background == first.has_background &&
+               same_color(cells[end].foreground, first.foreground) &&
+               (!first.has_background || same_color(cells[end].background, first.background))) {
+            append_utf8(run_, cells[end].glyph);
+            ++end;
+        }
+        ncplane_set_fg_rgb8(plane_, first.foreground.r, first.foreground.g, first.foreground.b);
+        if (first.has_background) {
+            ncplane_set_bg_rgb8(plane_, first.background.r, first.background.g, first.background.b);
+        } else {
+            ncplane_set_bg_default(plane_);
+        }
+        ncplane_putstr_yx(plane_, y, x + i, run_.c_str());
+        i = end;
+    }
+}
+
+void NotcursesBackend::text(int y, int x, Rgb foreground, std::string_view text) {
+    ncplane_set_fg_rgb8(plane_, foreground.r, foreground.g, foreground.b);
+    ncplane_set_bg_default(plane_);
+    ncplane_putnstr_yx(plane_, y, x, text.size(), text.data());
+}
+
+void NotcursesBackend::clear(int y, int x, int width) {
+    width = std::min(width, static_cast<int>(cols()) - x);
+    if (y < 0 || y >= static_cast<int>(rows()) || x < 0 || width <= 0) {
+        return;
+    }
+    ncplane_set_fg_default(plane_);
+    ncplane_set_bg_default(plane_);
+    ncplane_putstr_yx(plane_, y, x, run(width, ' ').c_str());
+}
+
+CellPixels NotcursesBackend::cell_pixels() const {
+    if (!pixel_support_) {
+        return {};
+    }
+    unsigned int cell_height = 0;
+    unsigned int cell_width = 0;
+    ncplane_pixel_geom(plane_, nullptr, nullptr, &cell_height, &cell_width, nullptr, nullptr);
+    return CellPixels{static_cast<int>(cell_width), static_cast<int>(cell_height)};
+}
+
+void NotcursesBackend::image(int y, int x, int rows, int cols, const std::uint32_t* rgba, int width, int height,
+                             const std::uint8_t* dirty_rows) {
+    if (!pixel_support_ || rows <= 0 || cols <= 0 || width <= 0 || height <= 0) {
+        return;
+    }
+    if (!image_bands_.empty() && (y != image_y_ || x != image_x_ || rows != image_rows_ || cols != image_cols_)) {
+        clear_image();
+    }
+    if (image_bands_.empty()) {
+        image_bands_.assign(static_cast<std::size_t>((rows + kImageBandRows - 1) / kImageBandRows), nullptr);
+        image_y_ = y;
+        image_x_ = x;
+        image_rows_ = rows;
+        image_cols_ = cols;
+    }
+    for (std::size_t band = 0; band < image_bands_.size(); ++band) {
+        const int top = static_cast<int>(band) * kImageBandRows;
+        const int bottom = std::min(rows, top + kImageBandRows);
+        ncplane*& plane = image_bands_[band];
+        const bool dirty = !dirty_rows || std::any_of(dirty_rows + top, dirty_rows + bottom, [](std::uint8_t row) {
+            return row != 0;
+        });
+        if (plane && !dirty) {
+            continue;
+        }
+        if (!plane) {
+            ncplane_options options{};
+            options.y = y + top;
+            options.x = x;
+            options.rows = static_cast<unsigned int>(bottom - top);
+            options.cols = static_cast<unsigned int>(cols);
+            options.name = "bitmap";
+            plane = ncplane_create(plane_, &options);
+            if (!plane) {
+                continue;
+            }
+        }
+        const int first_pixel_row = static_cast<int>(static_cast<long long>(top) * height / rows);
+        const int last_pixel_row = static_cast<int>(static_cast<long long>(bottom) * height / rows);
+        const std::uint32_t* pixels =
+            rgba + static_cast<std::size_t>(first_pixel_row) * static_cast<std::size_t>(width);
+        ncvisual* visual = ncvisual_from_rgba(pixels, last_pixel_row - first_pixel_row, width * 4, width);
+        if (!visual) {
+            continue;
+        }
+        // Re-blitting into the same plane lets notcurses replace the sprixel
+        // in place instead of allocating a new one each frame.
+        ncvisual_options options{};
+        options.n = plane;
+        options.scaling = NCSCALE_NONE;
+        options.blitter = NCBLIT_PIXEL;
+        ncvisual_blit(ncplane_notcurses(plane_), visual, &options);
+        ncvisual_destroy(visual);
+    }
+}
+
+void NotcursesBackend::clear_image() {
+    for (ncplane* plane : image_bands_) {
+        if (plane) {
+            ncplane_destroy(plane);
+        }
+    }
+    image_bands_.clear();
+}
+
+const std::string& NotcursesBackend::run(int width, char glyph) {
+    run_.assign(static_cast<std::size_t>(width), glyph);
+    return run_;
+}
+
+} // namespace who
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <notcurses/notcurses.h>
+
+#include "render_backend.h"
+
+namespace who {
+
+// Draws onto a notcurses plane; the caller still owns the plane and calls
+// notcurses_render. Bitmaps go to child planes of their own, one per band of
+// kImageBandRows rows, since pixel graphics cannot share a plane with text.
+class NotcursesBackend final : public RenderBackend {
+public:
+    explicit NotcursesBackend(ncplane* plane);
+    ~NotcursesBackend() override;
+
+    NotcursesBackend(const NotcursesBackend&) = delete;
+    NotcursesBackend& operator=(const NotcursesBackend&) = delete;
+
+    unsigned int rows() const override;
+    unsigned int cols() const override;
+
+    void erase() override;
+    void fill(int y, int x, int width, int count, int stride, Rgb background) override;
+    void glyphs(int y, int x, int width, char glyph, Rgb foreground) override;
+    void cells(int y, int x, const SubCell* cells, int count) override;
+    void text(int y, int x, Rgb foreground, std::string_view text) override;
+    void clear(int y, int x, int width) override;
+
+    CellPixels cell_pixels() const override;
+    void image(int y, int x, int rows, int cols, const std::uint32_t* rgba, int width, int height,
+               const std::uint8_t* dirty_rows) override;
+    void clear_image() override;
+
+private:
+    const std::string& run(int width, char glyph);
+
+    ncplane* plane_;
+    std::string run_;
+    bool pixel_support_;
+    std::vector<ncplane*> image_bands_;
+    int image_y_ = 0;
+    int image_x_ = 0;
+    int image_rows_ = 0;
+    int image_cols_ = 0;
+};
+
+} // namespace who
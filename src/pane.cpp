@@ -0,0 +1,130 @@
+#include "pane.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace who {
+
+namespace {
+// Status, audio metrics, frame metrics and band meter.
+constexpr unsigned int kMetricsRows = 4;
+
+ncplane* create_plane(ncplane* parent) {
+    ncplane_options options{};
+    options.rows = 1;
+    options.cols = 1;
+    options.name = "pane";
+    ncplane* plane = ncplane_create(parent, &options);
+    if (!plane) {
+        throw std::runtime_error("Failed to create pane plane");
+    }
+    return plane;
+}
+} // namespace
+
+Pane::Pane(ncplane* parent, const PaneSpec& spec, std::uint32_t surface, bool record)
+    : spec_(spec),
+      plane_(create_plane(parent)),
+      backend_(plane_),
+      recording_(record ? std::make_unique<RecordingBackend>(backend_, surface) : nullptr),
+      renderer_(recording_ ? static_cast<RenderBackend&>(*recording_) : backend_),
+      settings_(spec.view) {
+    spec_.frame_divisor = std::max(1, spec_.frame_divisor);
+    spec_.weight = spec_.weight > 0.0 ? spec_.weight : 1.0;
+}
+
+Pane::~Pane() { ncplane_destroy(plane_); }
+
+void Pane::place(int y, int x, unsigned int rows, unsigned int cols) {
+    if (y == y_ && x == x_ && rows == rows_ && cols == cols_) {
+        return;
+    }
+    y_ = y;
+    x_ = x;
+    rows_ = rows;
+    cols_ = cols;
+    if (recording_) {
+        recording_->place(y, x, rows, cols);
+    }
+    if (rows == 0 || cols == 0) {
+        // Planes cannot be empty; keep a single cell out of view instead.
+        ncplane_resize_simple(plane_, 1, 1);
+        ncplane_move_yx(plane_, -1, -1);
+        return;
+    }
+    ncplane_resize_simple(plane_, rows, cols);
+    ncplane_move_yx(plane_, y, x);
+}
+
+void Pane::update_settings(const ViewSettings& view) {
+    settings_.write_buffer() = view;
+    settings_.publish();
+}
+
+void Pane::draw(const FrameInput& input, bool overlay, const ViewSettings& focused) {
+    if (rows_ == 0 || cols_ == 0) {
+        return;
+    }
+    if (spec_.metrics) {
+        renderer_.draw_metrics(focused, input);
+        return;
+    }
+    renderer_.draw(settings_.read_buffer(), input, overlay);
+}
+
+void layout_panes(std::vector<std::unique_ptr<Pane>>& panes, unsigned int rows, unsigned int cols) {
+    double total_weight = 0.0;
+    unsigned int strip_rows = 0;
+    for (const std::unique_ptr<Pane>& pane : panes) {
+        if (pane->metrics()) {
+            strip_rows += kMetricsRows;
+        } else {
+            total_weight += pane->weight();
+        }
+    }
+    strip_rows = std::min(strip_rows, rows);
+    const unsigned int grid_rows = rows - strip_rows;
+
+    unsigned int strip_y = grid_rows;
+    double weight_before = 0.0;
+    for (std::unique_ptr<Pane>& pane : panes) {
+        if (pane->metrics()) {
+            const unsigned int height = std::min(kMetricsRows, rows - strip_y);
+            pane->place(static_cast<int>(strip_y), 0, height, height > 0 ? cols : 0);
+            strip_y += height;
+            continue;
+        }
+        // Columns are cut at cumulative weight boundaries so rounding never
+        // leaves gaps or overlaps.
+        const auto edge = [&](double weight) {
+            return static_cast<unsigned int>(static_cast<double>(cols) * weight / total_weight + 0.5);
+        };
+        const unsigned int left = edge(weight_before);
+        weight_before += pane->weight();
+        const unsigned int right = edge(weight_before);
+        pane->place(0, static_cast<int>(left), right > left ? grid_rows : 0, right - left);
+    }
+}
+
+bool panes_disjoint(const std::vector<std::unique_ptr<Pane>>& panes) {
+    for (std::size_t i = 0; i < panes.size(); ++i) {
+        const Pane& a = *panes[i];
+        if (a.rows() == 0 || a.cols() == 0) {
+            continue;
+        }
+        for (std::size_t j = i + 1; j < panes.size(); ++j) {
+            const Pane& b = *panes[j];
+            if (b.rows() == 0 || b.cols() == 0) {
+                continue;
+            }
+            const bool apart = a.x() + static_cast<int>(a.cols()) <= b.x() || b.x() + static_cast<int>(b.cols()) <= a.x() ||
+                               a.y() + static_cast<int>(a.rows()) <= b.y() || b.y() + static_cast<int>(b.rows()) <= a.y();
+            if (!apart) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace who
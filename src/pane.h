@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <notcurses/notcurses.h>
+
+#include "capture.h"
+#include "notcurses_backend.h"
+#include "renderer.h"
+#include "triple_buffer.h"
+
+namespace who {
+
+struct PaneSpec {
+    ViewSettings view;
+    // Metrics panes show only the overlay text, for the focused grid pane.
+    bool metrics = false;
+    // Draw on every Nth frame of the render loop.
+    int frame_divisor = 1;
+    // Share of the width among grid panes.
+    double weight = 1.0;
+};
+
+// One region of the terminal: a child plane of the standard plane with its
+// own backend, Renderer and view settings.
+class Pane {
+public:
+    // With `record`, everything drawn is also encoded as capture surface
+    // `surface`.
+    Pane(ncplane* parent, const PaneSpec& spec, std::uint32_t surface, bool record);
+    ~Pane();
+
+    Pane(const Pane&) = delete;
+    Pane& operator=(const Pane&) = delete;
+
+    // Moves and resizes the plane; a zero-sized pane is parked off-screen.
+    void place(int y, int x, unsigned int rows, unsigned int cols);
+
+    // Input-thread side: publishes new settings for the next frame.
+    void update_settings(const ViewSettings& view);
+    // Render-thread side: swaps in the newest settings, once per frame.
+    void refresh_settings() { settings_.update(); }
+    const ViewSettings& settings() const { return settings_.read_buffer(); }
+
+    void draw(const FrameInput& input, bool overlay, const ViewSettings& focused);
+
+    bool metrics() const { return spec_.metrics; }
+    double weight() const { return spec_.weight; }
+    bool due(std::uint64_t frame) const { return frame % static_cast<std::uint64_t>(spec_.frame_divisor) == 0; }
+
+    int y() const { return y_; }
+    int x() const { return x_; }
+    unsigned int rows() const { return rows_; }
+    unsigned int cols() const { return cols_; }
+
+    // Null unless the pane is recorded.
+    RecordingBackend* recording() { return recording_.get(); }
+
+private:
+    PaneSpec spec_;
+    ncplane* plane_;
+    NotcursesBackend backend_;
+    std::unique_ptr<RecordingBackend> recording_;
+    Renderer renderer_;
+    TripleBuffer<ViewSettings> settings_;
+    int y_ = 0;
+    int x_ = 0;
+    unsigned int rows_ = 0;
+    unsigned int cols_ = 0;
+};
+
+// Tiles the panes over a rows x cols area: metrics panes as full-width strips
+// along the bottom, grid panes side by side above them by weight.
+void layout_panes(std::vector<std::unique_ptr<Pane>>& panes, unsigned int rows, unsigned int cols);
+
+// True when no two non-empty panes share a terminal cell.
+bool panes_disjoint(const std::vector<std::unique_ptr<Pane>>& panes);
+
+} // namespace who
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace who {
+
+struct Rgb {
+    std::uint8_t r;
+    std::uint8_t g;
+    std::uint8_t b;
+};
+
+// One terminal cell of sub-cell output: `glyph` drawn in `foreground` over
+// `background`, or over the default background when !has_background.
+struct SubCell {
+    char32_t glyph;
+    Rgb foreground;
+    Rgb background;
+    bool has_background;
+};
+
+// Terminal rows per band of an image(); bands are separate bitmaps, so only
+// bands holding a dirty row are sent to the terminal again.
+constexpr int kImageBandRows = 2;
+
+// Size of one terminal cell in pixels; zero when the surface cannot show
+// bitmap graphics.
+struct CellPixels {
+    int width = 0;
+    int height = 0;
+};
+
+// Output surface for Renderer. Coordinates are terminal cells; the renderer
+// computes every colour and glyph and only hands finished spans to the backend.
+class RenderBackend {
+public:
+    virtual ~RenderBackend() = default;
+
+    virtual unsigned int rows() const = 0;
+    virtual unsigned int cols() const = 0;
+
+    // Clears the whole surface to default colours.
+    virtual void erase() = 0;
+    // Paints `count` spans of `width` cells with a solid background, the first
+    // starting at (y, x) and each following one `stride` (>= `width`) cells
+    // further right. Cells between spans are reset to default colours.
+    virtual void fill(int y, int x, int width, int count, int stride, Rgb background) = 0;
+    // Writes `width` copies of `glyph` in `foreground` over the default background.
+    virtual void glyphs(int y, int x, int width, char glyph, Rgb foreground) = 0;
+    // Writes `count` consecutive sub-cells starting at (y, x).
+    virtual void cells(int y, int x, const SubCell* cells, int count) = 0;
+    // Writes overlay text over the default background, clipped to the surface.
+    virtual void text(int y, int x, Rgb foreground, std::string_view text) = 0;
+    // Resets `width` cells starting at (y, x) to default colours.
+    virtual void clear(int y, int x, int width) = 0;
+
+    virtual CellPixels cell_pixels() const = 0;
+    // Shows a `width` x `height` bitmap (tightly packed R, G, B, A bytes) over
+    // `rows` x `cols` cells from (y, x), replacing the previous bitmap. When
+    // the placement and size are unchanged, `dirty_rows` (one flag per cell
+    // row, or nullptr for all of them) marks the rows that differ from it.
+    // Only valid while cell_pixels() is non-zero.
+    virtual void image(int y, int x, int rows, int cols, const std::uint32_t* rgba, int width, int height,
+                       const std::uint8_t* dirty_rows) = 0;
+    // Removes the bitmap, if any.
+    virtual void clear_image() = 0;
+};
+
+} // namespace who
@@ -0,0 +1,181 @@
+#include "render_worker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+namespace who {
+
+namespace {
+// The render thread draws too, so it counts towards the thread budget.
+std::size_t pool_workers(int render_threads, std::size_t panes) {
+    std::size_t threads = render_threads > 0 ? static_cast<std::size_t>(render_threads)
+                                             : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, panes);
+    return threads > 1 ? threads - 1 : 0;
+}
+} // namespace
+
+RenderWorker::RenderWorker(notcurses* nc,
+                           AnalysisSource& analysis,
+                           PluginManager& plugins,
+                           const RenderOptions& options,
+                           const std::vector<PaneSpec>& panes,
+                           Wakeup& wakeup,
+                           CaptureWriter* capture)
+    : nc_(nc),
+      analysis_(analysis),
+      plugins_(plugins),
+      options_(options),
+      pacer_(options.target_fps, options.min_fps, options.adaptive_fps),
+      focus_(0),
+      pool_(pool_workers(options.render_threads, panes.size())),
+      render_stats_(notcurses_stats_alloc(nc)),
+      wakeup_(wakeup),
+      capture_(capture),
+      stop_thread_(false),
+      failed_(false) {
+    ncplane* stdplane = notcurses_stdplane(nc);
+    bool focused = false;
+    for (const PaneSpec& spec : panes) {
+        const auto surface = static_cast<std::uint32_t>(panes_.size());
+        panes_.push_back(std::make_unique<Pane>(stdplane, spec, surface, capture != nullptr));
+        if (RecordingBackend* recording = panes_.back()->recording()) {
+            recordings_.push_back(recording);
+        }
+        has_metrics_pane_ = has_metrics_pane_ || spec.metrics;
+        if (!spec.metrics && !focused) {
+            focus_.store(panes_.size() - 1, std::memory_order_relaxed);
+            focused = true;
+        }
+    }
+    due_.reserve(panes_.size());
+}
+
+RenderWorker::~RenderWorker() {
+    stop();
+    std::free(render_stats_);
+}
+
+void RenderWorker::start() {
+    if (thread_.joinable()) {
+        return;
+    }
+    stop_thread_.store(false, std::memory_order_relaxed);
+    thread_ = std::thread(&RenderWorker::run, this);
+}
+
+void RenderWorker::stop() {
+    stop_thread_.store(true, std::memory_order_relaxed);
+    wakeup_.notify();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void RenderWorker::update_settings(std::size_t pane, const ViewSettings& settings) {
+    if (pane >= panes_.size()) {
+        return;
+    }
+    panes_[pane]->update_settings(settings);
+    wakeup_.notify();
+}
+
+void RenderWorker::set_focus(std::size_t pane) {
+    if (pane >= panes_.size() || panes_[pane]->metrics()) {
+        return;
+    }
+    focus_.store(pane, std::memory_order_relaxed);
+    wakeup_.notify();
+}
+
+void RenderWorker::draw_panes(const FrameInput& input, std::uint64_t frame) {
+    unsigned int rows = 0;
+    unsigned int cols = 0;
+    notcurses_stddim_yx(nc_, &rows, &cols);
+    if (rows != screen_rows_ || cols != screen_cols_) {
+        screen_rows_ = rows;
+        screen_cols_ = cols;
+        layout_panes(panes_, rows, cols);
+        // Every pane redraws at its new size, whatever its rate.
+        frame = 0;
+    }
+
+    // Bitmap blits go through notcurses' shared sprixel state, so frames with
+    // a pixel pane are drawn on this thread alone.
+    bool parallel = panes_disjoint(panes_);
+    due_.clear();
+    for (std::size_t i = 0; i < panes_.size(); ++i) {
+        panes_[i]->refresh_settings();
+        if (panes_[i]->due(frame)) {
+            due_.push_back(i);
+            parallel = parallel && panes_[i]->settings().blitter != GridBlitter::Pixel;
+        }
+    }
+
+    const std::size_t focus = focus_.load(std::memory_order_relaxed);
+    const ViewSettings& focused = panes_[focus]->settings();
+    const bool overlay = !has_metrics_pane_ && options_.show_metrics && options_.show_overlay_metrics;
+    const auto draw = [&](std::size_t index) {
+        const std::size_t pane = due_[index];
+        panes_[pane]->draw(input, overlay && pane == focus, focused);
+    };
+    // Distinct planes can be written concurrently; overlapping ones are drawn
+    // in order so the later pane's cells win as before.
+    if (parallel) {
+        pool_.parallel_for(due_.size(), draw);
+    } else {
+        for (std::size_t i = 0; i < due_.size(); ++i) {
+            draw(i);
+        }
+    }
+}
+
+void RenderWorker::run() {
+    const auto start_time = std::chrono::steady_clock::now();
+    pacer_.reset(start_time);
+    std::uint64_t frame = 0;
+
+    while (!stop_thread_.load(std::memory_order_relaxed)) {
+        const auto frame_start = std::chrono::steady_clock::now();
+        const float time_s = std::chrono::duration<float>(frame_start - start_time).count();
+
+        const AnalysisSnapshot& analysis = analysis_.latest();
+
+        plugins_.notify_frame(analysis.metrics, analysis.bands, analysis.beat_strength, time_s);
+
+        const FrameInput input{time_s,
+                               analysis.metrics,
+                               analysis.bands,
+                               analysis.beat_strength,
+                               options_.file_stream,
+                               pacer_.stats()};
+        draw_panes(input, frame++);
+        if (capture_) {
+            const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(frame_start - start_time);
+            capture_->write_frame(static_cast<std::uint64_t>(elapsed.count()), recordings_);
+        }
+
+        if (notcurses_render(nc_) != 0) {
+            std::cerr << "Failed to render frame" << std::endl;
+            failed_.store(true, std::memory_order_release);
+            break;
+        }
+
+        std::uint64_t bytes = 0;
+        if (render_stats_) {
+            notcurses_stats(nc_, render_stats_);
+            bytes = render_stats_->raster_bytes - raster_bytes_;
+            raster_bytes_ = render_stats_->raster_bytes;
+        }
+        pacer_.frame_rendered(frame_start, std::chrono::steady_clock::now(), bytes);
+        std::this_thread::sleep_until(pacer_.deadline());
+        if (!wakeup_.consume()) {
+            wakeup_.wait();
+            pacer_.resume(std::chrono::steady_clock::now());
+        }
+    }
+}
+
+} // namespace who
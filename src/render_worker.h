@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <notcurses/notcurses.h>
+
+#include "capture.h"
+#include "dsp_worker.h"
+#include "frame_pacer.h"
+#include "pane.h"
+#include "plugins.h"
+#include "thread_pool.h"
+#include "wakeup.h"
+
+namespace who {
+
+struct RenderOptions {
+    double target_fps = 60.0;
+    double min_fps = 15.0;
+    bool adaptive_fps = true;
+    bool file_stream = false;
+    bool show_metrics = true;
+    bool show_overlay_metrics = false;
+    // Worker threads for drawing panes in parallel; 0 picks one per pane up
+    // to the hardware concurrency.
+    int render_threads = 0;
+};
+
+// Draws and presents frames on its own thread, paced by a FramePacer, so input
+// handling and terminal output never delay each other. The screen is split
+// into panes, each with its own Renderer and view settings; settings arrive
+// from the input thread through a triple buffer per pane and take effect on
+// the next frame. Panes that do not overlap are drawn on a thread pool.
+//
+// A frame is only drawn after `wakeup` was notified, by the DSP worker
+// or feature player publishing new analysis or by the input thread, so the
+// thread sleeps while the audio is idle.
+//
+// With a CaptureWriter, every frame's output is also appended to the capture
+// file (--record).
+class RenderWorker {
+public:
+    RenderWorker(notcurses* nc,
+                 AnalysisSource& analysis,
+                 PluginManager& plugins,
+                 const RenderOptions& options,
+                 const std::vector<PaneSpec>& panes,
+                 Wakeup& wakeup,
+                 CaptureWriter* capture = nullptr);
+    ~RenderWorker();
+
+    RenderWorker(const RenderWorker&) = delete;
+    RenderWorker& operator=(const RenderWorker&) = delete;
+
+    void start();
+    void stop();
+
+    std::size_t pane_count() const { return panes_.size(); }
+
+    // Input-thread side: publishes new settings for one pane.
+    void update_settings(std::size_t pane, const ViewSettings& settings);
+    // Input-thread side: selects the grid pane whose settings the metrics
+    // show.
+    void set_focus(std::size_t pane);
+    // Input-thread side: redraws with unchanged settings (e.g. after a resize).
+    void request_frame() { wakeup_.notify(); }
+
+    // True once notcurses_render has failed; the worker stops drawing.
+    bool failed() const { return failed_.load(std::memory_order_acquire); }
+
+private:
+    void run();
+    void draw_panes(const FrameInput& input, std::uint64_t frame);
+
+    notcurses* nc_;
+    AnalysisSource& analysis_;
+    PluginManager& plugins_;
+    RenderOptions options_;
+    FramePacer pacer_;
+    std::vector<std::unique_ptr<Pane>> panes_;
+    std::vector<std::size_t> due_;
+    bool has_metrics_pane_ = false;
+    std::atomic<std::size_t> focus_;
+    unsigned int screen_rows_ = 0;
+    unsigned int screen_cols_ = 0;
+    ThreadPool pool_;
+    // Terminal output counters, read after every render for bytes/frame.
+    ncstats* render_stats_;
+    std::uint64_t raster_bytes_ = 0;
+    Wakeup& wakeup_;
+    CaptureWriter* capture_;
+    std::vector<RecordingBackend*> recordings_;
+
+    std::thread thread_;
+    std::atomic<bool> stop_thread_;
+    std::atomic<bool> failed_;
+};
+
+} // namespace who
@@ -1,29 +1,167 @@
 #include "renderer.h"
 
+#include "simd_kernels.h"
+
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
 #include <string>
 #include <string_view>
 
 namespace who {
 namespace {
 
-struct Rgb {
-    uint8_t r;
-    uint8_t g;
-    uint8_t b;
+// Per-cell render state in structure-of-arrays form so smoothing and
+// quantisation run as straight loops over the whole grid.
+struct CellPlanes {
+    std::vector<float> target_r;
+    std::vector<float> target_g;
+    std::vector<float> target_b;
+    std::vector<float> smooth_r;
+    std::vector<float> smooth_g;
+    std::vector<float> smooth_b;
+    std::vector<float> ascii_drive;
+    std::vector<uint8_t> color_r;
+    std::vector<uint8_t> color_g;
+    std::vector<uint8_t> color_b;
+    std::vector<char> glyph;
+    // False until the first frame after a reset has seeded the smoothing.
+    bool primed{false};
+
+    void reset(std::size_t count) {
+        for (std::vector<float>* plane : {&target_r, &target_g, &target_b, &smooth_r, &smooth_g, &smooth_b, &ascii_drive}) {
+            plane->assign(count, 0.0f);
+        }
+        for (std::vector<uint8_t>* plane : {&color_r, &color_g, &color_b}) {
+            plane->assign(count, 0);
+        }
+        glyph.assign(count, ' ');
+        primed = false;
+    }
+
+    std::size_t size() const { return glyph.size(); }
+    Rgb color(std::size_t index) const { return Rgb{color_r[index], color_g[index], color_b[index]}; }
+};
+
+// Per-frame values shared by a whole band, row or column, so the per-cell
+// loop does no transcendental math.
+struct FrameTables {
+    std::vector<float> band_level;     // normalised energy per band
+    std::vector<float> band_intensity; // band_level^1.5 (digital)
+    std::vector<float> band_high;      // normalised energy of the look-ahead band (ASCII)
+    std::vector<float> column_wave;
+    std::vector<float> column_hue_shift;
+    std::vector<float> column_jitter;
+    std::vector<float> column_design;
+    std::vector<float> row_shimmer_sin;
+    std::vector<float> row_shimmer_cos;
+    std::vector<float> row_jitter;
+    std::vector<float> row_swirl_sin;
+    std::vector<float> row_swirl_cos;
+    std::vector<float> row_texture_sin;
+    std::vector<float> row_texture_cos;
+};
+
+// Constants of each palette's digital rendering.
+struct DigitalPalette {
+    float base_r;
+    float base_g;
+    float base_b;
+    int quantization_levels;
+};
+
+DigitalPalette digital_spec(ColorPalette palette) {
+    switch (palette) {
+    case ColorPalette::DigitalAmber:
+        return {255.0f / 255.0f, 180.0f / 255.0f, 48.0f / 255.0f, 5};
+    case ColorPalette::DigitalCyan:
+        return {48.0f / 255.0f, 220.0f / 255.0f, 255.0f / 255.0f, 6};
+    case ColorPalette::DigitalViolet:
+        return {208.0f / 255.0f, 64.0f / 255.0f, 255.0f / 255.0f, 7};
+    default:
+        return {200.0f / 255.0f, 200.0f / 255.0f, 200.0f / 255.0f, 6};
+    }
+}
+
+// Geometry-only per-cell quantities, rebuilt when the grid, mode or band
+// count changes so the per-frame loop needs no sqrt/atan2. Per-cell arrays
+// are indexed r * cols + c. Trails derives its band from time each frame and
+// only uses column_phase.
+struct LayoutTable {
+    int rows{-1};
+    int cols{-1};
+    VisualizationMode mode{VisualizationMode::Bands};
+    std::size_t band_count{0};
+    std::vector<uint32_t> band_index;
+    std::vector<float> band_mix;
+    std::vector<float> base_hue;
+    std::vector<float> column_ratio; // per column
+    std::vector<float> column_phase; // per column
+    std::vector<int> row_y;          // per row: first terminal row (solid/ASCII)
+    std::vector<int> column_x;       // per column: first terminal column (solid/ASCII)
+    // Column halves of the separable per-cell waves, sin/cos(k * c).
+    std::vector<float> shimmer_sin;
+    std::vector<float> shimmer_cos;
+    std::vector<float> swirl_sin;
+    std::vector<float> swirl_cos;
+    std::vector<float> texture_sin;
+    std::vector<float> texture_cos;
 };
 
-struct CellState {
-    float smooth_r{0.0f};
-    float smooth_g{0.0f};
-    float smooth_b{0.0f};
-    Rgb color{0, 0, 0};
-    char glyph{' '};
-    bool valid{false};
+// One line of overlay text as last written to the surface; y < 0 when the
+// line is not on screen.
+struct TextLine {
+    int y{-1};
+    int x{0};
+    std::string text;
 };
 
+// Status, audio metrics, frame metrics, band meter.
+constexpr std::size_t kOverlayLines = 4;
+
+void clear_text(RenderBackend& backend, TextLine& line) {
+    if (line.y >= 0 && !line.text.empty()) {
+        backend.clear(line.y, line.x, static_cast<int>(line.text.size()));
+    }
+    line.y = -1;
+    line.text.clear();
+}
+
+// Rewrites only the span of `text` that differs from what the line already
+// shows, and clears any leftover tail of a longer previous text. `overwrite`
+// rewrites it all, for lines that other output may have painted over.
+void update_text(RenderBackend& backend, TextLine& line, int y, int x, Rgb color, std::string_view text, bool overwrite) {
+    if (line.y != y || line.x != x) {
+        clear_text(backend, line);
+        line.y = y;
+        line.x = x;
+    }
+    const std::string& previous = line.text;
+    const std::size_t common = std::min(previous.size(), text.size());
+    std::size_t first = 0;
+    while (!overwrite && first < common && previous[first] == text[first]) {
+        ++first;
+    }
+    std::size_t last = text.size();
+    if (!overwrite && previous.size() == text.size()) {
+        while (last > first && previous[last - 1] == text[last - 1]) {
+            --last;
+        }
+    }
+    if (first < last) {
+        backend.text(y, x + static_cast<int>(first), color, text.substr(first, last - first));
+    }
+    if (text.size() < previous.size()) {
+        backend.clear(y, x + static_cast<int>(text.size()), static_cast<int>(previous.size() - text.size()));
+    }
+    line.text.assign(text.begin(), text.end());
+}
+
 struct GridCache {
     int rows{0};
     int cols{0};
@@ -31,36 +169,351 @@ struct GridCache {
     int cell_w{0};
     int offset_y{0};
     int offset_x{0};
-    std::vector<CellState> cells;
-    std::string fill;
+    GridBlitter blitter{GridBlitter::Solid};
+    // Pixels per terminal cell the layout was computed with (1x1 for whole
+    // cells).
+    int pixel_w{1};
+    int pixel_h{1};
+    CellPlanes cells;
+    LayoutTable layout;
+    FrameTables frame;
+    std::vector<uint8_t> row_dirty;
+    // Sub-cell blitters only: which grid rows changed this frame, and the last
+    // glyph/colours written to each terminal cell of the grid area.
+    std::vector<uint8_t> grid_row_dirty;
+    std::vector<SubCell> subcells;
+    std::vector<uint8_t> subcell_valid;
+    // Pixel blitter only: the bitmap last shown, kept so that only dirty grid
+    // rows are rasterised again, and which of its terminal rows they touched.
+    std::vector<std::uint32_t> image;
+    std::vector<uint8_t> image_dirty;
+    int image_width{0};
+    int image_height{0};
+
+    // What is currently on screen outside the per-cell state, so later frames
+    // only touch what changed: the terminal rectangle the grid occupies, the
+    // surface size it was laid out for, and each overlay line's text.
+    int drawn_top{0};
+    int drawn_left{0};
+    int drawn_bottom{0};
+    int drawn_right{0};
+    unsigned int surface_rows{0};
+    unsigned int surface_cols{0};
+    std::array<TextLine, kOverlayLines> overlay;
 };
 
-GridCache& grid_cache() {
-    static GridCache cache;
-    return cache;
+struct PixelLayout {
+    int width;
+    int height;
+};
+
+PixelLayout pixel_layout(GridBlitter blitter) {
+    switch (blitter) {
+    case GridBlitter::HalfBlock:
+        return {1, 2};
+    case GridBlitter::Quadrant:
+        return {2, 2};
+    case GridBlitter::Sextant:
+        return {2, 3};
+    case GridBlitter::Braille:
+        return {2, 4};
+    case GridBlitter::Solid:
+    case GridBlitter::Pixel:
+        break;
+    }
+    return {1, 1};
 }
 
-float clamp01(float v) {
-    return std::max(0.0f, std::min(1.0f, v));
+// Maps a mask of lit sub-pixels (bit index = row * width + column) to the
+// glyph drawing them in the foreground colour.
+char32_t blitter_glyph(GridBlitter blitter, unsigned int mask) {
+    switch (blitter) {
+    case GridBlitter::HalfBlock: {
+        static constexpr char32_t kHalves[4] = {U' ', U'\u2580', U'\u2584', U'\u2588'};
+        return kHalves[mask & 3u];
+    }
+    case GridBlitter::Quadrant: {
+        static constexpr char32_t kQuadrants[16] = {U' ',      U'\u2598', U'\u259D', U'\u2580', U'\u2596', U'\u258C',
+                                                    U'\u259E', U'\u259B', U'\u2597', U'\u259A', U'\u2590', U'\u259C',
+                                                    U'\u2584', U'\u2599', U'\u259F', U'\u2588'};
+        return kQuadrants[mask & 15u];
+    }
+    case GridBlitter::Sextant:
+        // U+1FB00.. covers every pattern except those with existing glyphs:
+        // blank, left half, right half and full block.
+        switch (mask & 63u) {
+        case 0:
+            return U' ';
+        case 21:
+            return U'\u258C';
+        case 42:
+            return U'\u2590';
+        case 63:
+            return U'\u2588';
+        default:
+            return static_cast<char32_t>(0x1FB00u + mask - 1u - (mask > 21u ? 1u : 0u) - (mask > 42u ? 1u : 0u));
+        }
+    case GridBlitter::Braille: {
+        static constexpr unsigned int kDots[8] = {0x01, 0x08, 0x02, 0x10, 0x04, 0x20, 0x40, 0x80};
+        unsigned int dots = 0;
+        for (unsigned int bit = 0; bit < 8; ++bit) {
+            if (mask & (1u << bit)) {
+                dots |= kDots[bit];
+            }
+        }
+        return static_cast<char32_t>(0x2800u + dots);
+    }
+    case GridBlitter::Solid:
+    case GridBlitter::Pixel:
+        break;
+    }
+    return U' ';
 }
 
-float hue_to_rgb(float p, float q, float t) {
-    if (t < 0.0f) {
-        t += 1.0f;
+bool same_subcell(const SubCell& a, const SubCell& b) {
+    return a.glyph == b.glyph && a.has_background == b.has_background && a.foreground.r == b.foreground.r &&
+           a.foreground.g == b.foreground.g && a.foreground.b == b.foreground.b &&
+           (!a.has_background || (a.background.r == b.background.r && a.background.g == b.background.g &&
+                                  a.background.b == b.background.b));
+}
+
+int color_distance(Rgb a, Rgb b) {
+    const int dr = static_cast<int>(a.r) - static_cast<int>(b.r);
+    const int dg = static_cast<int>(a.g) - static_cast<int>(b.g);
+    const int db = static_cast<int>(a.b) - static_cast<int>(b.b);
+    return dr * dr + dg * dg + db * db;
+}
+
+Rgb average_color(const Rgb* pixels, unsigned int mask, int count) {
+    int r = 0;
+    int g = 0;
+    int b = 0;
+    int n = 0;
+    for (int i = 0; i < count; ++i) {
+        if (mask & (1u << i)) {
+            r += pixels[i].r;
+            g += pixels[i].g;
+            b += pixels[i].b;
+            ++n;
+        }
+    }
+    if (n == 0) {
+        return Rgb{0, 0, 0};
+    }
+    return Rgb{static_cast<uint8_t>((r + n / 2) / n), static_cast<uint8_t>((g + n / 2) / n),
+               static_cast<uint8_t>((b + n / 2) / n)};
+}
+
+// Reduces one terminal cell's sub-pixels to a glyph plus at most two colours.
+// Gutter pixels (not in `lit`) stay on the default background; a fully lit
+// cell is split around its two most distant colours.
+SubCell quantize_subcell(GridBlitter blitter, const Rgb* pixels, unsigned int lit, int count) {
+    const unsigned int all = (1u << count) - 1u;
+    if (lit == 0) {
+        return SubCell{U' ', Rgb{0, 0, 0}, Rgb{0, 0, 0}, false};
+    }
+    if (lit != all || blitter == GridBlitter::Braille) {
+        return SubCell{blitter_glyph(blitter, lit), average_color(pixels, lit, count), Rgb{0, 0, 0}, false};
+    }
+
+    int first = 0;
+    int second = 0;
+    int widest = 0;
+    for (int i = 0; i < count; ++i) {
+        for (int j = i + 1; j < count; ++j) {
+            const int distance = color_distance(pixels[i], pixels[j]);
+            if (distance > widest) {
+                widest = distance;
+                first = i;
+                second = j;
+            }
+        }
     }
-    if (t > 1.0f) {
-        t -= 1.0f;
+    if (widest == 0) {
+        return SubCell{U' ', pixels[0], pixels[0], true};
     }
-    if (t < 1.0f / 6.0f) {
-        return p + (q - p) * 6.0f * t;
+
+    unsigned int mask = 0;
+    for (int i = 0; i < count; ++i) {
+        if (color_distance(pixels[i], pixels[first]) <= color_distance(pixels[i], pixels[second])) {
+            mask |= 1u << i;
+        }
     }
-    if (t < 1.0f / 2.0f) {
-        return q;
+    return SubCell{blitter_glyph(blitter, mask), average_color(pixels, mask, count),
+                   average_color(pixels, all & ~mask, count), true};
+}
+
+// Rebuilds the terminal cells covering dirty grid rows and writes each run of
+// cells that differ from the previous frame with a single backend call.
+void blit_sub_cells(RenderBackend& backend,
+                    GridCache& cache,
+                    PixelLayout layout,
+                    int term_top,
+                    int term_left,
+                    int term_bottom,
+                    int term_right) {
+    const int span_rows = std::max(0, std::min(term_bottom, static_cast<int>(backend.rows())) - term_top);
+    const int span_cols = std::max(0, std::min(term_right, static_cast<int>(backend.cols())) - term_left);
+    const std::size_t span_size = static_cast<std::size_t>(span_rows) * static_cast<std::size_t>(span_cols);
+    if (cache.subcells.size() != span_size) {
+        cache.subcells.assign(span_size, SubCell{U' ', Rgb{0, 0, 0}, Rgb{0, 0, 0}, false});
+        cache.subcell_valid.assign(span_size, 0);
     }
-    if (t < 2.0f / 3.0f) {
-        return p + (q - p) * (2.0f / 3.0f - t) * 6.0f;
+
+    // Gutters of one logical pixel separate cells once they are big enough.
+    const int gap_y = cache.cell_h >= 3 ? 1 : 0;
+    const int gap_x = cache.cell_w >= 3 ? 1 : 0;
+    const int grid_height = cache.cell_h * cache.rows;
+    const int grid_width = cache.cell_w * cache.cols;
+    const int count = layout.width * layout.height;
+
+    Rgb pixels[8];
+    for (int row = 0; row < span_rows; ++row) {
+        const int ty = term_top + row;
+        const int first_py = ty * layout.height - cache.offset_y;
+        const int last_py = first_py + layout.height - 1;
+        const int first_grid_row = std::clamp(first_py / cache.cell_h, 0, cache.rows - 1);
+        const int last_grid_row = std::clamp(last_py / cache.cell_h, 0, cache.rows - 1);
+        bool dirty = false;
+        for (int gr = first_grid_row; gr <= last_grid_row; ++gr) {
+            dirty = dirty || cache.grid_row_dirty[static_cast<std::size_t>(gr)] != 0;
+        }
+        if (!dirty) {
+            continue;
+        }
+
+        SubCell* cached = cache.subcells.data() + static_cast<std::size_t>(row) * span_cols;
+        uint8_t* valid = cache.subcell_valid.data() + static_cast<std::size_t>(row) * span_cols;
+        int run_start = -1;
+        for (int col = 0; col <= span_cols; ++col) {
+            bool changed = false;
+            if (col < span_cols) {
+                const int tx = term_left + col;
+                unsigned int lit = 0;
+                for (int sy = 0; sy < layout.height; ++sy) {
+                    const int py = first_py + sy;
+                    for (int sx = 0; sx < layout.width; ++sx) {
+                        const int px = tx * layout.width + sx - cache.offset_x;
+                        const int bit = sy * layout.width + sx;
+                        if (py < 0 || px < 0 || py >= grid_height || px >= grid_width) {
+                            continue;
+                        }
+                        const int gr = py / cache.cell_h;
+                        const int gc = px / cache.cell_w;
+                        if (py - gr * cache.cell_h >= cache.cell_h - gap_y || px - gc * cache.cell_w >= cache.cell_w - gap_x) {
+                            continue;
+                        }
+                        pixels[bit] = cache.cells.color(static_cast<std::size_t>(gr * cache.cols + gc));
+                        lit |= 1u << bit;
+                    }
+                }
+                const SubCell next = quantize_subcell(cache.blitter, pixels, lit, count);
+                changed = !valid[col] || !same_subcell(cached[col], next);
+                if (changed) {
+                    cached[col] = next;
+                    valid[col] = 1;
+                }
+            }
+            if (changed && run_start < 0) {
+                run_start = col;
+            } else if (!changed && run_start >= 0) {
+                backend.cells(ty, term_left + run_start, cached + run_start, col - run_start);
+                run_start = -1;
+            }
+        }
     }
-    return p;
+}
+
+std::uint32_t pack_rgba(Rgb color) {
+    const uint8_t bytes[4] = {color.r, color.g, color.b, 255};
+    std::uint32_t pixel = 0;
+    std::memcpy(&pixel, bytes, sizeof(pixel));
+    return pixel;
+}
+
+// Rasterises dirty grid rows into the cached bitmap covering the grid's
+// terminal cells and shows it, flagging the terminal rows those grid rows
+// touched so the backend can skip the rest. Each cell is a block of
+// pixels; gutters and margins stay transparent so the terminal background
+// shows through as it does between whole-cell blocks.
+void blit_image(RenderBackend& backend,
+                GridCache& cache,
+                PixelLayout layout,
+                int term_top,
+                int term_left,
+                int term_bottom,
+                int term_right) {
+    const int span_rows = std::max(0, std::min(term_bottom, static_cast<int>(backend.rows())) - term_top);
+    const int span_cols = std::max(0, std::min(term_right, static_cast<int>(backend.cols())) - term_left);
+    if (span_rows == 0 || span_cols == 0) {
+        return;
+    }
+    const int width = span_cols * layout.width;
+    const int height = span_rows * layout.height;
+    bool redraw_all = false;
+    if (cache.image_width != width || cache.image_height != height) {
+        cache.image.assign(static_cast<std::size_t>(width) * static_cast<std::size_t>(height), 0u);
+        cache.image_width = width;
+        cache.image_height = height;
+        redraw_all = true;
+    }
+    cache.image_dirty.assign(static_cast<std::size_t>(span_rows), 0);
+
+    const int origin_y = cache.offset_y - term_top * layout.height;
+    const int origin_x = cache.offset_x - term_left * layout.width;
+    const int gap_y = cache.cell_h >= 4 ? std::max(1, cache.cell_h / 8) : 0;
+    const int gap_x = cache.cell_w >= 4 ? std::max(1, cache.cell_w / 8) : 0;
+    const int row_left = std::max(0, origin_x);
+    const int row_right = std::min(width, origin_x + cache.cols * cache.cell_w);
+    bool dirty = redraw_all;
+    for (int gr = 0; gr < cache.rows; ++gr) {
+        if (!redraw_all && !cache.grid_row_dirty[static_cast<std::size_t>(gr)]) {
+            continue;
+        }
+        const int top = std::max(0, origin_y + gr * cache.cell_h);
+        const int bottom = std::min(height, origin_y + gr * cache.cell_h + cache.cell_h - gap_y);
+        if (top >= bottom || row_left >= row_right) {
+            continue;
+        }
+        dirty = true;
+        std::fill(cache.image_dirty.begin() + top / layout.height,
+                  cache.image_dirty.begin() + (bottom - 1) / layout.height + 1,
+                  uint8_t{1});
+        // One scanline per grid row, then copied down the rest of the row.
+        std::uint32_t* scanline = cache.image.data() + static_cast<std::size_t>(top) * static_cast<std::size_t>(width);
+        for (int gc = 0; gc < cache.cols; ++gc) {
+            const int left = std::max(0, origin_x + gc * cache.cell_w);
+            const int right = std::min(width, origin_x + gc * cache.cell_w + cache.cell_w - gap_x);
+            if (left < right) {
+                kernels::fill_u32(scanline + left,
+                                  pack_rgba(cache.cells.color(static_cast<std::size_t>(gr * cache.cols + gc))),
+                                  static_cast<std::size_t>(right - left));
+            }
+        }
+        for (int y = top + 1; y < bottom; ++y) {
+            std::memcpy(cache.image.data() + static_cast<std::size_t>(y) * static_cast<std::size_t>(width) + row_left,
+                        scanline + row_left,
+                        static_cast<std::size_t>(row_right - row_left) * sizeof(std::uint32_t));
+        }
+    }
+    if (dirty) {
+        backend.image(term_top, term_left, span_rows, span_cols, cache.image.data(), width, height,
+                      redraw_all ? nullptr : cache.image_dirty.data());
+    }
+}
+
+float clamp01(float v) {
+    return std::max(0.0f, std::min(1.0f, v));
+}
+
+// Closed-form HSL: each channel is l - a * clamp(min(k - 3, 9 - k), -1, 1)
+// with k = (n + 12h) mod 12, which is branch-free apart from the wrap.
+float hsl_channel(float n, float h, float l, float a) {
+    float k = n + h * 12.0f;
+    if (k >= 12.0f) {
+        k -= 12.0f;
+    }
+    return l - a * std::max(-1.0f, std::min(std::min(k - 3.0f, 9.0f - k), 1.0f));
 }
 
 Rgb hsl_to_rgb(float h, float s, float l) {
@@ -71,23 +524,102 @@ Rgb hsl_to_rgb(float h, float s, float l) {
     s = clamp01(s);
     l = clamp01(l);
 
-    float r;
-    float g;
-    float b;
+    const float a = s * std::min(l, 1.0f - l);
+    return Rgb{static_cast<uint8_t>(hsl_channel(0.0f, h, l, a) * 255.0f + 0.5f),
+               static_cast<uint8_t>(hsl_channel(8.0f, h, l, a) * 255.0f + 0.5f),
+               static_cast<uint8_t>(hsl_channel(4.0f, h, l, a) * 255.0f + 0.5f)};
+}
 
-    if (s == 0.0f) {
-        r = g = b = l;
-    } else {
-        const float q = l < 0.5f ? l * (1.0f + s) : l + s - l * s;
-        const float p = 2.0f * l - q;
-        r = hue_to_rgb(p, q, h + 1.0f / 3.0f);
-        g = hue_to_rgb(p, q, h);
-        b = hue_to_rgb(p, q, h - 1.0f / 3.0f);
+void build_layout(LayoutTable& layout,
+                  int rows,
+                  int cols,
+                  VisualizationMode mode,
+                  std::size_t band_count,
+                  int offset_y,
+                  int offset_x,
+                  int cell_h,
+                  int cell_w) {
+    layout.rows = rows;
+    layout.cols = cols;
+    layout.mode = mode;
+    layout.band_count = band_count;
+
+    const std::size_t cells = static_cast<std::size_t>(std::max(rows, 0) * std::max(cols, 0));
+    layout.band_index.assign(cells, 0);
+    layout.band_mix.assign(cells, 0.0f);
+    layout.base_hue.assign(cells, 0.0f);
+    layout.column_ratio.assign(static_cast<std::size_t>(std::max(cols, 0)), 0.0f);
+    layout.column_phase.assign(static_cast<std::size_t>(std::max(cols, 0)), 0.0f);
+
+    layout.row_y.resize(static_cast<std::size_t>(std::max(rows, 0)));
+    layout.column_x.resize(static_cast<std::size_t>(std::max(cols, 0)));
+    for (int r = 0; r < rows; ++r) {
+        layout.row_y[static_cast<std::size_t>(r)] = offset_y + r * cell_h;
+    }
+    for (std::vector<float>* column : {&layout.shimmer_sin, &layout.shimmer_cos, &layout.swirl_sin, &layout.swirl_cos,
+                                       &layout.texture_sin, &layout.texture_cos}) {
+        column->resize(static_cast<std::size_t>(std::max(cols, 0)));
+    }
+    for (int c = 0; c < cols; ++c) {
+        const std::size_t column = static_cast<std::size_t>(c);
+        layout.shimmer_sin[column] = std::sin(static_cast<float>(c) * 0.22f);
+        layout.shimmer_cos[column] = std::cos(static_cast<float>(c) * 0.22f);
+        layout.swirl_sin[column] = std::sin(static_cast<float>(c) * 0.9f);
+        layout.swirl_cos[column] = std::cos(static_cast<float>(c) * 0.9f);
+        layout.texture_sin[column] = std::sin(static_cast<float>(c) * 0.35f);
+        layout.texture_cos[column] = std::cos(static_cast<float>(c) * 0.35f);
+        layout.column_x[static_cast<std::size_t>(c)] = offset_x + c * cell_w;
+        layout.column_ratio[static_cast<std::size_t>(c)] =
+            cols > 1 ? static_cast<float>(c) / static_cast<float>(cols - 1) : 0.0f;
+        layout.column_phase[static_cast<std::size_t>(c)] = static_cast<float>(c) / std::max(1, cols - 1);
     }
 
-    return Rgb{static_cast<uint8_t>(std::round(r * 255.0f)),
-               static_cast<uint8_t>(std::round(g * 255.0f)),
-               static_cast<uint8_t>(std::round(b * 255.0f))};
+    const float center_row = (rows - 1) / 2.0f;
+    const float center_col = (cols - 1) / 2.0f;
+    const float max_radius = std::max(1.0f, std::sqrt(center_row * center_row + center_col * center_col));
+    constexpr float inv_two_pi = 0.15915494309189535f; // 1 / (2π)
+
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            const std::size_t index = static_cast<std::size_t>(r * cols + c);
+            std::size_t band_index = 0;
+            float band_mix = 0.0f;
+            float base_hue = layout.column_ratio[static_cast<std::size_t>(c)];
+            if (band_count > 0) {
+                switch (mode) {
+                case VisualizationMode::Bands:
+                case VisualizationMode::Digital:
+                case VisualizationMode::Ascii: {
+                    const float band_t = static_cast<float>(r) / static_cast<float>(rows);
+                    band_index = std::min<std::size_t>(band_count - 1,
+                                                        static_cast<std::size_t>(band_t * static_cast<float>(band_count)));
+                    band_mix = static_cast<float>(band_index) / std::max<std::size_t>(1, band_count - 1);
+                    base_hue = mode == VisualizationMode::Bands
+                                   ? static_cast<float>(band_index) / static_cast<float>(band_count)
+                                   : static_cast<float>(band_index) / std::max<std::size_t>(1, band_count);
+                    break;
+                }
+                case VisualizationMode::Radial: {
+                    const float dr = static_cast<float>(r) - center_row;
+                    const float dc = static_cast<float>(c) - center_col;
+                    const float radius = std::sqrt(dr * dr + dc * dc);
+                    const float normalized = clamp01(radius / max_radius);
+                    band_index = std::min<std::size_t>(band_count - 1,
+                                                        static_cast<std::size_t>(normalized * static_cast<float>(band_count)));
+                    band_mix = normalized;
+                    const float angle = std::atan2(dr, dc);
+                    base_hue = std::fmod(angle * inv_two_pi + 1.0f, 1.0f);
+                    break;
+                }
+                case VisualizationMode::Trails:
+                    break;
+                }
+            }
+            layout.band_index[index] = static_cast<uint32_t>(band_index);
+            layout.band_mix[index] = band_mix;
+            layout.base_hue[index] = base_hue;
+        }
+    }
 }
 
 constexpr std::string_view kAsciiGlyphs =
@@ -110,6 +642,81 @@ std::string format_band_meter(const std::vector<float>& bands) {
     return line;
 }
 
+// Writes the metrics overlay lines from (y, x). Rows above `overwrite_below`
+// are shared with grid output and are rewritten in full.
+void draw_overlay(RenderBackend& backend,
+                  GridCache& cache,
+                  const ViewSettings& view,
+                  GridBlitter active_blitter,
+                  const FrameInput& input,
+                  int y,
+                  int x,
+                  int overwrite_below) {
+    const unsigned int plane_rows = backend.rows();
+    const AudioMetrics& metrics = input.metrics;
+    const FrameStats& frame_stats = input.frame_stats;
+
+    constexpr Rgb overlay_color{200, 200, 200};
+    char line[256];
+    auto put_line = [&](std::size_t index, std::string_view text) {
+        const int line_y = y + static_cast<int>(index);
+        if (line_y >= static_cast<int>(plane_rows)) {
+            clear_text(backend, cache.overlay[index]);
+            return;
+        }
+        update_text(backend, cache.overlay[index], line_y, x, overlay_color, text, line_y < overwrite_below);
+    };
+    std::snprintf(line,
+                  sizeof(line),
+                  "Audio %s | Mode: %s | Palette: %s | Blit: %s | Grid: %dx%d | Sens: %.2f",
+                  metrics.active ? (input.file_stream ? "file" : "capturing") : "inactive",
+                  mode_name(view.mode),
+                  palette_name(view.palette),
+                  blitter_name(active_blitter),
+                  view.grid_rows,
+                  view.grid_cols,
+                  view.sensitivity);
+    put_line(0, line);
+
+    std::snprintf(line,
+                  sizeof(line),
+                  "RMS: %.3f | Peak: %.3f | Dropped: %zu | Beat: %.2f",
+                  metrics.rms,
+                  metrics.peak,
+                  metrics.dropped,
+                  clamp01(input.beat_strength));
+    put_line(1, line);
+
+    std::snprintf(line,
+                  sizeof(line),
+                  "Frames: %llu (%llu skipped) | Render p50/p99: %.2f/%.2f ms | FPS: %.0f | Out: %.0f B/frame",
+                  static_cast<unsigned long long>(frame_stats.frames_rendered),
+                  static_cast<unsigned long long>(frame_stats.frames_skipped),
+                  frame_stats.render_p50_ms,
+                  frame_stats.render_p99_ms,
+                  frame_stats.fps,
+                  frame_stats.bytes_per_frame);
+    put_line(2, line);
+
+    put_line(3, format_band_meter(input.bands));
+}
+
+
+// Drops overlay text records that a smaller surface clipped, so it is
+// written out again once there is room.
+void track_surface(GridCache& cache, unsigned int rows, unsigned int cols) {
+    if (cache.surface_rows == rows && cache.surface_cols == cols) {
+        return;
+    }
+    if (cols > cache.surface_cols || rows > cache.surface_rows) {
+        for (TextLine& line : cache.overlay) {
+            line.text.clear();
+        }
+    }
+    cache.surface_rows = rows;
+    cache.surface_cols = cols;
+}
+
 } // namespace
 
 const char* mode_name(VisualizationMode mode) {
@@ -129,6 +736,25 @@ const char* mode_name(VisualizationMode mode) {
     }
 }
 
+const char* blitter_name(GridBlitter blitter) {
+    switch (blitter) {
+    case GridBlitter::Solid:
+        return "Solid";
+    case GridBlitter::HalfBlock:
+        return "Half-block";
+    case GridBlitter::Quadrant:
+        return "Quadrant";
+    case GridBlitter::Sextant:
+        return "Sextant";
+    case GridBlitter::Braille:
+        return "Braille";
+    case GridBlitter::Pixel:
+        return "Pixel";
+    default:
+        return "Unknown";
+    }
+}
+
 const char* palette_name(ColorPalette palette) {
     switch (palette) {
     case ColorPalette::Rainbow:
@@ -146,65 +772,123 @@ const char* palette_name(ColorPalette palette) {
     }
 }
 
-void draw_grid(notcurses* nc,
-               int grid_rows,
-               int grid_cols,
-               float time_s,
-               VisualizationMode mode,
-               ColorPalette palette,
-               float sensitivity,
-               const AudioMetrics& metrics,
-               const std::vector<float>& bands,
-               float beat_strength,
-               bool file_stream,
-               bool show_metrics,
-               bool show_overlay_metrics) {
-    ncplane* stdplane = notcurses_stdplane(nc);
-    unsigned int plane_rows = 0;
-    unsigned int plane_cols = 0;
-    ncplane_dim_yx(stdplane, &plane_rows, &plane_cols);
+struct Renderer::Cache {
+    GridCache grid;
+};
+
+Renderer::Renderer(RenderBackend& backend) : backend_(backend), cache_(std::make_unique<Cache>()) {}
+
+Renderer::~Renderer() = default;
+
+void Renderer::draw(const ViewSettings& view, const FrameInput& input, bool overlay) {
+    RenderBackend& backend = backend_;
+    GridCache& cache = cache_->grid;
+    const int grid_rows = view.grid_rows;
+    const int grid_cols = view.grid_cols;
+    const VisualizationMode mode = view.mode;
+    const ColorPalette palette = view.palette;
+    const float time_s = input.time_s;
+    const std::vector<float>& bands = input.bands;
+    const float beat_strength = input.beat_strength;
+
+    const unsigned int plane_rows = backend.rows();
+    const unsigned int plane_cols = backend.cols();
 
     const bool ascii_mode = mode == VisualizationMode::Ascii;
 
-    const int cell_h_from_rows = grid_rows > 0 ? static_cast<int>(plane_rows) / grid_rows : 0;
-    const int cell_h_from_cols = ascii_mode ? (grid_cols > 0 ? static_cast<int>(plane_cols) / grid_cols : 0)
-                                            : (grid_cols > 0 ? static_cast<int>(plane_cols) / (grid_cols * 2) : 0);
-    const int cell_h = std::max(1, std::min(cell_h_from_rows, cell_h_from_cols));
-    const int cell_w = ascii_mode ? std::max(1, grid_cols > 0 ? static_cast<int>(plane_cols) / grid_cols : 1)
-                                  : cell_h * 2;
+    // ASCII Flux is glyph-based and always uses whole terminal cells, as does
+    // the pixel blitter on surfaces without bitmap support.
+    GridBlitter active_blitter = ascii_mode ? GridBlitter::Solid : view.blitter;
+    const CellPixels cell_pixels = backend.cell_pixels();
+    if (active_blitter == GridBlitter::Pixel && (cell_pixels.width <= 0 || cell_pixels.height <= 0)) {
+        active_blitter = GridBlitter::Solid;
+    }
+    const bool bitmap = active_blitter == GridBlitter::Pixel;
+    const bool sub_cell = active_blitter != GridBlitter::Solid;
+    const PixelLayout sub_pixels =
+        bitmap ? PixelLayout{cell_pixels.width, cell_pixels.height} : pixel_layout(active_blitter);
+
+    // In sub-cell mode, cell sizes and offsets are in logical pixels
+    // (sub_pixels.width x sub_pixels.height per terminal cell) rather than cells.
+    int cell_h = 1;
+    int cell_w = 1;
+    if (bitmap) {
+        // Real pixels are square.
+        const int max_h = grid_rows > 0 ? static_cast<int>(plane_rows) * sub_pixels.height / grid_rows : 0;
+        const int max_w = grid_cols > 0 ? static_cast<int>(plane_cols) * sub_pixels.width / grid_cols : 0;
+        cell_h = std::max(1, std::min(max_h, max_w));
+        cell_w = cell_h;
+    } else if (sub_cell) {
+        const int pixel_rows = static_cast<int>(plane_rows) * sub_pixels.height;
+        const int pixel_cols = static_cast<int>(plane_cols) * sub_pixels.width;
+        const int max_h = grid_rows > 0 ? pixel_rows / grid_rows : 0;
+        const int max_w = grid_cols > 0 ? pixel_cols / grid_cols : 0;
+        // Terminal cells are about twice as tall as wide; keep grid cells square.
+        cell_h = std::max(1, std::min(max_h, max_w * sub_pixels.height / (2 * sub_pixels.width)));
+        cell_w = std::max(1, std::min(max_w, (cell_h * 2 * sub_pixels.width + sub_pixels.height / 2) / sub_pixels.height));
+    } else {
+        const int cell_h_from_rows = grid_rows > 0 ? static_cast<int>(plane_rows) / grid_rows : 0;
+        const int cell_h_from_cols = ascii_mode ? (grid_cols > 0 ? static_cast<int>(plane_cols) / grid_cols : 0)
+                                                : (grid_cols > 0 ? static_cast<int>(plane_cols) / (grid_cols * 2) : 0);
+        cell_h = std::max(1, std::min(cell_h_from_rows, cell_h_from_cols));
+        cell_w = ascii_mode ? std::max(1, grid_cols > 0 ? static_cast<int>(plane_cols) / grid_cols : 1) : cell_h * 2;
+    }
 
     const int grid_height = cell_h * grid_rows;
     const int grid_width = cell_w * grid_cols;
 
-    const int offset_y = std::max(0, (static_cast<int>(plane_rows) - grid_height) / 2);
-    const int offset_x = std::max(0, (static_cast<int>(plane_cols) - grid_width) / 2);
+    const int offset_y = std::max(0, (static_cast<int>(plane_rows) * sub_pixels.height - grid_height) / 2);
+    const int offset_x = std::max(0, (static_cast<int>(plane_cols) * sub_pixels.width - grid_width) / 2);
+
+    // Terminal-cell bounds of the grid area.
+    const int term_top = offset_y / sub_pixels.height;
+    const int term_left = offset_x / sub_pixels.width;
+    const int term_bottom = (offset_y + grid_height + sub_pixels.height - 1) / sub_pixels.height;
+    const int term_right = (offset_x + grid_width + sub_pixels.width - 1) / sub_pixels.width;
 
-    GridCache& cache = grid_cache();
     const bool geometry_changed = cache.rows != grid_rows || cache.cols != grid_cols || cache.cell_h != cell_h ||
-                                  cache.cell_w != cell_w || cache.offset_y != offset_y || cache.offset_x != offset_x;
+                                  cache.cell_w != cell_w || cache.offset_y != offset_y || cache.offset_x != offset_x ||
+                                  cache.blitter != active_blitter || cache.pixel_w != sub_pixels.width ||
+                                  cache.pixel_h != sub_pixels.height;
 
     if (geometry_changed) {
-        ncplane_erase(stdplane);
+        // Only the area the old layout painted needs clearing; the rest of
+        // the surface is already blank.
+        for (int y = cache.drawn_top; y < cache.drawn_bottom; ++y) {
+            backend.clear(y, cache.drawn_left, cache.drawn_right - cache.drawn_left);
+        }
+        for (TextLine& line : cache.overlay) {
+            clear_text(backend, line);
+        }
+        backend.clear_image();
+        cache.image_width = 0;
+        cache.image_height = 0;
+        cache.drawn_top = term_top;
+        cache.drawn_left = term_left;
+        cache.drawn_bottom = std::min(term_bottom, static_cast<int>(plane_rows));
+        cache.drawn_right = std::min(term_right, static_cast<int>(plane_cols));
         cache.rows = grid_rows;
         cache.cols = grid_cols;
         cache.cell_h = cell_h;
         cache.cell_w = cell_w;
         cache.offset_y = offset_y;
         cache.offset_x = offset_x;
-        cache.cells.assign(static_cast<std::size_t>(grid_rows * grid_cols), CellState{});
+        cache.blitter = active_blitter;
+        cache.pixel_w = sub_pixels.width;
+        cache.pixel_h = sub_pixels.height;
+        cache.cells.reset(static_cast<std::size_t>(grid_rows * grid_cols));
+        cache.subcells.clear();
+        cache.subcell_valid.clear();
     } else if (cache.cells.size() != static_cast<std::size_t>(grid_rows * grid_cols)) {
-        cache.cells.assign(static_cast<std::size_t>(grid_rows * grid_cols), CellState{});
+        cache.cells.reset(static_cast<std::size_t>(grid_rows * grid_cols));
     }
-
-    ncplane_set_fg_default(stdplane);
+    // A resize that keeps the layout leaves the grid in place and exposes
+    // blank cells; only clipped overlay text has to be written out again.
+    track_surface(cache, plane_rows, plane_cols);
 
     const int v_gap = ascii_mode ? 0 : 1;
     const int h_gap = ascii_mode ? 0 : 2;
     const int fill_w = std::max(1, cell_w - h_gap);
-    if (static_cast<int>(cache.fill.size()) != fill_w) {
-        cache.fill.assign(static_cast<std::size_t>(fill_w), ' ');
-    }
-    const std::string& cell_fill = cache.fill;
     const int draw_height = std::max(1, cell_h - v_gap);
 
     const std::size_t band_count = bands.size();
@@ -219,7 +903,7 @@ void draw_grid(notcurses* nc,
     }
 
     const float reference_energy = std::max(max_band_energy, mean_band_energy * 1.5f);
-    const float user_gain = std::max(0.1f, sensitivity);
+    const float user_gain = std::max(0.1f, view.sensitivity);
     const float gain = reference_energy > 0.0f ? user_gain / reference_energy : user_gain;
     const float log_denom = std::log1p(9.0f);
 
@@ -228,11 +912,6 @@ void draw_grid(notcurses* nc,
         return clamp01(log_denom > 0.0f ? scaled / log_denom : 0.0f);
     };
 
-    const float center_row = (grid_rows - 1) / 2.0f;
-    const float center_col = (grid_cols - 1) / 2.0f;
-    const float max_radius = std::max(1.0f, std::sqrt(center_row * center_row + center_col * center_col));
-    constexpr float inv_two_pi = 0.15915494309189535f; // 1 / (2π)
-
     const bool full_refresh = geometry_changed;
 
     const bool digital_mode = mode == VisualizationMode::Digital;
@@ -242,358 +921,337 @@ void draw_grid(notcurses* nc,
 
     const float beat_flash = clamp01(beat_strength);
 
-    for (int r = 0; r < grid_rows; ++r) {
-        for (int c = 0; c < grid_cols; ++c) {
-            std::size_t band_index = 0;
-            float band_mix = 0.0f;
-            if (band_count > 0) {
-                switch (mode) {
-                case VisualizationMode::Bands:
-                case VisualizationMode::Digital:
-                case VisualizationMode::Ascii: {
-                    const float band_t = static_cast<float>(r) / static_cast<float>(grid_rows);
-                    band_index = std::min<std::size_t>(band_count - 1,
-                                                        static_cast<std::size_t>(band_t * static_cast<float>(band_count)));
-                    band_mix = static_cast<float>(band_index) / std::max<std::size_t>(1, band_count - 1);
-                    break;
-                }
-                case VisualizationMode::Radial: {
-                    const float dr = static_cast<float>(r) - center_row;
-                    const float dc = static_cast<float>(c) - center_col;
-                    const float radius = std::sqrt(dr * dr + dc * dc);
-                    const float normalized = clamp01(radius / max_radius);
-                    band_index = std::min<std::size_t>(band_count - 1,
-                                                        static_cast<std::size_t>(normalized * static_cast<float>(band_count)));
-                    band_mix = normalized;
+    cache.row_dirty.assign(static_cast<std::size_t>(std::max(grid_cols, 0)), 0);
+    cache.grid_row_dirty.assign(static_cast<std::size_t>(std::max(grid_rows, 0)), 0);
+
+    // Dirty cells of one grid row are gathered first, then emitted as runs of
+    // identical colour (and glyph): one style change per run and terminal row.
+    auto flush_row = [&](int r) {
+        const std::size_t row_base = static_cast<std::size_t>(r * grid_cols);
+        int c = 0;
+        while (c < grid_cols) {
+            if (!cache.row_dirty[static_cast<std::size_t>(c)]) {
+                ++c;
+                continue;
+            }
+            const CellPlanes& cells = cache.cells;
+            const std::size_t first = row_base + static_cast<std::size_t>(c);
+            const Rgb color = cells.color(first);
+            int end = c + 1;
+            while (end < grid_cols && cache.row_dirty[static_cast<std::size_t>(end)]) {
+                const std::size_t next = row_base + static_cast<std::size_t>(end);
+                if (cells.color_r[next] != color.r || cells.color_g[next] != color.g || cells.color_b[next] != color.b ||
+                    (ascii_mode && cells.glyph[next] != cells.glyph[first])) {
                     break;
                 }
-                case VisualizationMode::Trails: {
-                    const float column_phase = static_cast<float>(c) / std::max(1, grid_cols - 1);
-                    float trail_phase = std::fmod(time_s * 0.35f + column_phase, 1.0f);
-                    if (trail_phase < 0.0f) {
-                        trail_phase += 1.0f;
+                ++end;
+            }
+
+            const int count = end - c;
+            const int x = cache.layout.column_x[static_cast<std::size_t>(c)];
+            if (x < static_cast<int>(plane_cols)) {
+                for (int dy = 0; dy < draw_height; ++dy) {
+                    const int y = cache.layout.row_y[static_cast<std::size_t>(r)] + dy;
+                    if (y >= static_cast<int>(plane_rows)) {
+                        break;
+                    }
+                    if (ascii_mode) {
+                        backend.glyphs(y, x, (count - 1) * cell_w + fill_w, cells.glyph[first], color);
+                    } else {
+                        backend.fill(y, x, fill_w, count, cell_w, color);
                     }
-                    band_index = std::min<std::size_t>(band_count - 1,
-                                                        static_cast<std::size_t>(trail_phase * static_cast<float>(band_count)));
-                    band_mix = trail_phase;
-                    break;
-                }
                 }
             }
+            std::fill(cache.row_dirty.begin() + c, cache.row_dirty.begin() + end, 0);
+            c = end;
+        }
+    };
 
-            const float band_energy = (band_index < band_count) ? bands[band_index] : 0.0f;
-            const float energy_level = normalize_energy(band_energy);
+    LayoutTable& layout = cache.layout;
+    if (geometry_changed || layout.rows != grid_rows || layout.cols != grid_cols || layout.mode != mode ||
+        layout.band_count != band_count) {
+        build_layout(layout, grid_rows, grid_cols, mode, band_count, offset_y, offset_x, cell_h, cell_w);
+    }
+    const bool trails_mode = mode == VisualizationMode::Trails;
+    const std::size_t cell_count = static_cast<std::size_t>(grid_rows * grid_cols);
+    CellPlanes& cells = cache.cells;
+    FrameTables& frame = cache.frame;
+
+    // Per-band, per-column and per-row terms for this frame.
+    frame.band_level.resize(band_count);
+    frame.band_intensity.resize(band_count);
+    frame.band_high.resize(band_count);
+    for (std::size_t band = 0; band < band_count; ++band) {
+        frame.band_level[band] = normalize_energy(bands[band]);
+    }
+    for (std::size_t band = 0; band < band_count; ++band) {
+        if (use_digital) {
+            frame.band_intensity[band] = std::pow(frame.band_level[band], 1.5f);
+        }
+        if (ascii_mode) {
+            frame.band_high[band] =
+                frame.band_level[std::min<std::size_t>(band_count - 1, band + std::max<std::size_t>(1, band_count / 6))];
+        }
+    }
 
-            const float column_ratio = grid_cols > 1 ? static_cast<float>(c) / static_cast<float>(grid_cols - 1) : 0.0f;
-            const float time_wave = use_digital ? 0.0f : std::sin(time_s * 1.3f + column_ratio * 3.0f);
-            const float shimmer = use_digital ? 0.0f : std::sin(time_s * 0.9f + r * 0.35f + c * 0.22f);
+    const DigitalPalette digital = digital_spec(palette);
+    const bool violet_checker = use_digital && palette == ColorPalette::DigitalViolet;
+    const int violet_toggle = static_cast<int>(time_s * 8.0f) % 2;
+    const float violet_design[2] = {1.2f + beat_strength * 0.3f, 0.6f + beat_strength * 0.1f}; // Pulse with beat
+
+    const std::size_t columns = static_cast<std::size_t>(std::max(grid_cols, 0));
+    frame.column_wave.resize(columns);
+    frame.column_hue_shift.resize(columns);
+    frame.column_jitter.resize(columns);
+    frame.column_design.assign(columns, 1.0f);
+    for (std::size_t c = 0; c < columns; ++c) {
+        const float column_ratio = layout.column_ratio[c];
+        frame.column_wave[c] = use_digital ? 0.0f : std::sin(time_s * 1.3f + column_ratio * 3.0f);
+        frame.column_hue_shift[c] = std::fmod(time_s * 0.05f + column_ratio * 0.15f, 1.0f);
+        if (ascii_mode) {
+            frame.column_jitter[c] = std::cos(time_s * 1.8f + static_cast<float>(c) * 0.7f);
+        }
+    }
+    if (use_digital && palette == ColorPalette::DigitalCyan && grid_cols > 0) {
+        const int scan_rate = 4;
+        const int step = static_cast<int>(time_s * static_cast<float>(scan_rate));
+        int scan_col = step % grid_cols;
+        if (scan_col < 0) {
+            scan_col += grid_cols;
+        }
+        for (int c = 0; c < grid_cols; ++c) {
+            const int distance = std::abs(c - scan_col);
+            if (distance == 0) {
+                frame.column_design[static_cast<std::size_t>(c)] = 1.35f + beat_strength * 0.5f; // Brighter on beat
+            } else if (distance == 1) {
+                frame.column_design[static_cast<std::size_t>(c)] = 1.1f + beat_strength * 0.2f;
+            } else {
+                frame.column_design[static_cast<std::size_t>(c)] = 0.85f;
+            }
+        }
+    }
 
-            float target_r = 0.0f;
-            float target_g = 0.0f;
-            float target_b = 0.0f;
-            float ascii_drive = 0.0f;
-            char target_glyph = ' ';
+    const std::size_t row_count = static_cast<std::size_t>(std::max(grid_rows, 0));
+    for (std::vector<float>* row : {&frame.row_shimmer_sin, &frame.row_shimmer_cos, &frame.row_jitter, &frame.row_swirl_sin,
+                                    &frame.row_swirl_cos, &frame.row_texture_sin, &frame.row_texture_cos}) {
+        row->resize(row_count);
+    }
+    for (std::size_t r = 0; r < row_count; ++r) {
+        const float row = static_cast<float>(r);
+        if (!use_digital) {
+            const float shimmer_phase = time_s * 0.9f + row * 0.35f;
+            frame.row_shimmer_sin[r] = std::sin(shimmer_phase);
+            frame.row_shimmer_cos[r] = std::cos(shimmer_phase);
+        }
+        if (ascii_mode) {
+            frame.row_jitter[r] = std::sin(time_s * 2.6f + row * 0.9f);
+            const float swirl_phase = time_s * 6.2f + row * 0.8f;
+            frame.row_swirl_sin[r] = std::sin(swirl_phase);
+            frame.row_swirl_cos[r] = std::cos(swirl_phase);
+            // ASCII bands follow rows, so band_mix is constant along a row.
+            const float row_mix = columns > 0 ? layout.band_mix[r * columns] : 0.0f;
+            const float texture_phase = time_s * 3.3f + row_mix * 6.2831853f + row * 0.35f;
+            frame.row_texture_sin[r] = std::sin(texture_phase);
+            frame.row_texture_cos[r] = std::cos(texture_phase);
+        }
+    }
 
-            if (ascii_mode) {
-                float high_energy = 0.0f;
-                if (band_count > 0) {
-                    const std::size_t lookahead = std::min<std::size_t>(band_count - 1,
-                                                                         band_index + std::max<std::size_t>(1, band_count / 6));
-                    high_energy = normalize_energy(bands[lookahead]);
+    // Digital intensity quantisation is fixed for the frame.
+    const float beat_multiplier = 1.0f + clamp01(beat_strength) * 1.2f; // Increased multiplier
+    float beat_floor = 0.0f;
+    float beat_color_shift = 0.0f;
+    if (palette == ColorPalette::DigitalAmber && beat_strength > 0.6f) {
+        beat_floor = 0.85f;
+        beat_color_shift = 0.1f; // Shift towards yellow/white
+    }
+    int quantization_levels = digital.quantization_levels;
+    if (beat_strength > 0.5f) {
+        quantization_levels = std::max(2, quantization_levels - 2); // Fewer levels on strong beats
+    }
+    const float levels = static_cast<float>(quantization_levels);
+
+    // Pass 1: target colours.
+    for (int r = 0; r < grid_rows; ++r) {
+        const std::size_t row = static_cast<std::size_t>(r);
+        for (int c = 0; c < grid_cols; ++c) {
+            const std::size_t column = static_cast<std::size_t>(c);
+            const std::size_t cell_index = row * columns + column;
+            std::size_t band_index = layout.band_index[cell_index];
+            float band_mix = layout.band_mix[cell_index];
+            if (trails_mode && band_count > 0) {
+                float trail_phase = std::fmod(time_s * 0.35f + layout.column_phase[column], 1.0f);
+                if (trail_phase < 0.0f) {
+                    trail_phase += 1.0f;
                 }
-                const float jitter_a = std::sin(time_s * 2.6f + static_cast<float>(r) * 0.9f);
-                const float jitter_b = std::cos(time_s * 1.8f + static_cast<float>(c) * 0.7f);
-                const float jitter = (jitter_a + jitter_b) * 0.25f + 0.5f;
+                band_index = std::min<std::size_t>(band_count - 1,
+                                                    static_cast<std::size_t>(trail_phase * static_cast<float>(band_count)));
+                band_mix = trail_phase;
+            }
+            const float energy_level = band_index < band_count ? frame.band_level[band_index] : 0.0f;
+
+            float ascii_drive = 0.0f;
+            if (ascii_mode) {
+                const float high_energy = band_index < band_count ? frame.band_high[band_index] : 0.0f;
+                const float jitter = (frame.row_jitter[row] + frame.column_jitter[column]) * 0.25f + 0.5f;
                 ascii_drive = clamp01(0.45f * energy_level + 0.25f * high_energy + 0.15f * jitter + 0.15f * band_mix);
                 ascii_drive = clamp01(ascii_drive + beat_strength * 0.25f);
+                cells.ascii_drive[cell_index] = ascii_drive;
             }
 
             if (use_digital) {
-                Rgb base_color{200, 200, 200};
-                int quantization_levels = 6;
-                float design_multiplier = 1.0f;
-                float beat_floor = 0.0f;
-                float beat_color_shift = 0.0f; // New: for subtle color shifts on beat
-
-                switch (palette) {
-                case ColorPalette::DigitalAmber:
-                    base_color = Rgb{255, 180, 48};
-                    quantization_levels = 5;
-                    if (beat_strength > 0.6f) {
-                        beat_floor = 0.85f;
-                        beat_color_shift = 0.1f; // Shift towards yellow/white
-                    }
-                    break;
-                case ColorPalette::DigitalCyan: {
-                    base_color = Rgb{48, 220, 255};
-                    quantization_levels = 6;
-                    const int scan_rate = 4;
-                    if (grid_cols > 0) {
-                        const int step = static_cast<int>(time_s * static_cast<float>(scan_rate));
-                        int scan_col = 0;
-                        if (grid_cols > 0) {
-                            scan_col = step % grid_cols;
-                            if (scan_col < 0) {
-                                scan_col += grid_cols;
-                            }
-                        }
-                        const int distance = std::abs(c - scan_col);
-                        if (distance == 0) {
-                            design_multiplier = 1.35f + beat_strength * 0.5f; // Brighter on beat
-                        } else if (distance == 1) {
-                            design_multiplier = 1.1f + beat_strength * 0.2f;
-                        } else {
-                            design_multiplier = 0.85f;
-                        }
-                    }
-                    break;
-                }
-                case ColorPalette::DigitalViolet: {
-                    base_color = Rgb{208, 64, 255};
-                    quantization_levels = 7;
-                    const int toggle = static_cast<int>(time_s * 8.0f) % 2;
-                    const int parity = (r + c + toggle) % 2;
-                    design_multiplier = (parity == 0) ? (1.2f + beat_strength * 0.3f) : (0.6f + beat_strength * 0.1f); // Pulse with beat
-                    break;
-                }
-                default:
-                    break;
-                }
-
-                const float base_r = static_cast<float>(base_color.r) / 255.0f;
-                const float base_g = static_cast<float>(base_color.g) / 255.0f;
-                const float base_b = static_cast<float>(base_color.b) / 255.0f;
-
+                const float design_multiplier =
+                    violet_checker ? violet_design[(r + c + violet_toggle) % 2] : frame.column_design[column];
+                const float band_intensity = band_index < band_count ? frame.band_intensity[band_index] : 0.0f;
                 // More aggressive beat reaction and non-linear energy mapping
-                const float beat_multiplier = 1.0f + clamp01(beat_strength) * 1.2f; // Increased multiplier
-                float intensity = std::pow(energy_level, 1.5f) * beat_multiplier * design_multiplier; // Non-linear energy
-
+                float intensity = band_intensity * beat_multiplier * design_multiplier;
                 if (beat_floor > 0.0f) {
                     intensity = std::max(intensity, beat_floor);
                 }
-
-                // Dynamic quantization
-                int current_quantization_levels = quantization_levels;
-                if (beat_strength > 0.5f) {
-                    current_quantization_levels = std::max(2, quantization_levels - 2); // Fewer levels on strong beats
-                }
-                if (current_quantization_levels > 1) {
-                    intensity = std::round(intensity * static_cast<float>(current_quantization_levels)) /
-                                static_cast<float>(current_quantization_levels);
+                if (quantization_levels > 1) {
+                    intensity = std::round(intensity * levels) / levels;
                 }
                 if (intensity < 0.05f) {
                     intensity = 0.0f;
                 }
-
-                target_r = clamp01(base_r * intensity + beat_color_shift);
-                target_g = clamp01(base_g * intensity + beat_color_shift);
-                target_b = clamp01(base_b * intensity + beat_color_shift);
-            } else {
-                float base_hue = column_ratio;
-                if (band_count > 0) {
-                    switch (mode) {
-                    case VisualizationMode::Bands:
-                        base_hue = static_cast<float>(band_index) / static_cast<float>(band_count);
-                        break;
-                    case VisualizationMode::Radial: {
-                        const float dr = static_cast<float>(r) - center_row;
-                        const float dc = static_cast<float>(c) - center_col;
-                        const float angle = std::atan2(dr, dc);
-                        base_hue = std::fmod(angle * inv_two_pi + 1.0f, 1.0f);
-                        break;
-                    }
-                    case VisualizationMode::Trails:
-                        base_hue = band_mix;
-                        break;
-                    case VisualizationMode::Digital: // Should not be reached due to use_digital check
-                    case VisualizationMode::Ascii:    // Should not be reached due to ascii_mode check
-                        base_hue = static_cast<float>(band_index) / std::max<std::size_t>(1, band_count);
-                        break;
-                    }
-                }
-
-                const float hue_shift = std::fmod(time_s * 0.05f + column_ratio * 0.15f, 1.0f);
-
-                float hue = std::fmod(base_hue + hue_shift, 1.0f);
-                float saturation = clamp01(0.55f + energy_level * 0.4f + shimmer * 0.05f);
-                float brightness = clamp01(0.12f + energy_level * (0.82f + beat_flash * 0.35f) + time_wave * 0.12f +
-                                           beat_flash * 0.12f);
-
-                if (palette == ColorPalette::WarmCool) {
-                    const float warm_cool_base = clamp01(band_mix);
-                    const float warm_cool_hue = std::fmod(0.58f - warm_cool_base * 0.42f + shimmer * 0.02f, 1.0f);
-                    hue = std::fmod(warm_cool_hue + beat_flash * 0.05f, 1.0f);
-                    saturation = clamp01(0.45f + energy_level * 0.35f + shimmer * 0.08f);
-                    brightness = clamp01(0.18f + energy_level * (0.75f + beat_flash * 0.45f) + time_wave * 0.08f +
-                                          beat_flash * 0.18f);
-                }
-
-                if (ascii_mode) {
-                    saturation = clamp01(saturation + 0.2f + ascii_drive * 0.1f);
-                    brightness = clamp01(brightness + ascii_drive * 0.4f + beat_flash * 0.1f);
-                }
-
-                const Rgb target_color = hsl_to_rgb(hue, saturation, brightness);
-                target_r = clamp01(static_cast<float>(target_color.r) / 255.0f);
-                target_g = clamp01(static_cast<float>(target_color.g) / 255.0f);
-                target_b = clamp01(static_cast<float>(target_color.b) / 255.0f);
-            }
-
-            const std::size_t cell_index = static_cast<std::size_t>(r * grid_cols + c);
-            if (cell_index >= cache.cells.size()) {
+                cells.target_r[cell_index] = clamp01(digital.base_r * intensity + beat_color_shift);
+                cells.target_g[cell_index] = clamp01(digital.base_g * intensity + beat_color_shift);
+                cells.target_b[cell_index] = clamp01(digital.base_b * intensity + beat_color_shift);
                 continue;
             }
 
-            CellState& state = cache.cells[cell_index];
-            if (!state.valid || full_refresh) {
-                state.smooth_r = target_r;
-                state.smooth_g = target_g;
-                state.smooth_b = target_b;
-            } else {
-                // Adjust smoothing based on beat_strength for more reactivity
-                float base_smoothing = 0.22f;
-                if (use_digital) {
-                    base_smoothing = 0.55f;
-                } else if (ascii_mode) {
-                    base_smoothing = 0.3f;
-                }
-                const float dynamic_smoothing = base_smoothing + beat_strength * 0.3f; // More reactive on beat
-                state.smooth_r += (target_r - state.smooth_r) * dynamic_smoothing;
-                state.smooth_g += (target_g - state.smooth_g) * dynamic_smoothing;
-                state.smooth_b += (target_b - state.smooth_b) * dynamic_smoothing;
+            // sin(row_phase + k * c), expanded so both halves come from tables.
+            const float shimmer =
+                frame.row_shimmer_sin[row] * layout.shimmer_cos[column] + frame.row_shimmer_cos[row] * layout.shimmer_sin[column];
+            const float time_wave = frame.column_wave[column];
+            const float base_hue = (trails_mode && band_count > 0) ? band_mix : layout.base_hue[cell_index];
+
+            float hue = std::fmod(base_hue + frame.column_hue_shift[column], 1.0f);
+            float saturation = clamp01(0.55f + energy_level * 0.4f + shimmer * 0.05f);
+            float brightness =
+                clamp01(0.12f + energy_level * (0.82f + beat_flash * 0.35f) + time_wave * 0.12f + beat_flash * 0.12f);
+
+            if (palette == ColorPalette::WarmCool) {
+                const float warm_cool_base = clamp01(band_mix);
+                const float warm_cool_hue = std::fmod(0.58f - warm_cool_base * 0.42f + shimmer * 0.02f, 1.0f);
+                hue = std::fmod(warm_cool_hue + beat_flash * 0.05f, 1.0f);
+                saturation = clamp01(0.45f + energy_level * 0.35f + shimmer * 0.08f);
+                brightness =
+                    clamp01(0.18f + energy_level * (0.75f + beat_flash * 0.45f) + time_wave * 0.08f + beat_flash * 0.18f);
             }
 
             if (ascii_mode) {
-                const float luma = clamp01(state.smooth_r * 0.299f + state.smooth_g * 0.587f + state.smooth_b * 0.114f);
-                const float swirl = (std::sin(time_s * 6.2f + static_cast<float>(r) * 0.8f - static_cast<float>(c) * 0.9f) + 1.0f) *
-                                    0.5f;
-                const float texture = (std::sin(time_s * 3.3f + band_mix * 6.2831853f + static_cast<float>(r + c) * 0.35f) + 1.0f) *
-                                      0.5f;
-                const float ascii_mix = clamp01(0.45f * ascii_drive + 0.35f * luma + 0.2f * swirl);
-                const float ascii_value = clamp01(ascii_mix * 0.75f + texture * 0.25f + beat_strength * 0.2f);
-                const std::size_t glyph_count = kAsciiGlyphs.size();
-                const std::size_t glyph_idx = (glyph_count > 1)
-                                                  ? std::min<std::size_t>(
-                                                        glyph_count - 1,
-                                                        static_cast<std::size_t>(std::round(
-                                                            ascii_value * static_cast<float>(glyph_count - 1))))
-                                                  : 0;
-                target_glyph = static_cast<char>(kAsciiGlyphs[glyph_idx]);
+                saturation = clamp01(saturation + 0.2f + ascii_drive * 0.1f);
+                brightness = clamp01(brightness + ascii_drive * 0.4f + beat_flash * 0.1f);
             }
 
-            const Rgb color{static_cast<uint8_t>(std::round(clamp01(state.smooth_r) * 255.0f)),
-                            static_cast<uint8_t>(std::round(clamp01(state.smooth_g) * 255.0f)),
-                            static_cast<uint8_t>(std::round(clamp01(state.smooth_b) * 255.0f))};
+            const Rgb target_color = hsl_to_rgb(hue, saturation, brightness);
+            cells.target_r[cell_index] = static_cast<float>(target_color.r) / 255.0f;
+            cells.target_g[cell_index] = static_cast<float>(target_color.g) / 255.0f;
+            cells.target_b[cell_index] = static_cast<float>(target_color.b) / 255.0f;
+        }
+    }
 
-            bool needs_update = full_refresh || !state.valid || state.color.r != color.r || state.color.g != color.g ||
-                                state.color.b != color.b;
+    // Pass 2: smoothing, adjusted by beat_strength for more reactivity.
+    const bool seed = full_refresh || !cells.primed;
+    float base_smoothing = 0.22f;
+    if (use_digital) {
+        base_smoothing = 0.55f;
+    } else if (ascii_mode) {
+        base_smoothing = 0.3f;
+    }
+    const float smoothing = seed ? 1.0f : base_smoothing + beat_strength * 0.3f;
+    auto smooth_plane = [&](const std::vector<float>& target, std::vector<float>& smooth) {
+        if (seed) {
+            std::copy(target.begin(), target.begin() + static_cast<std::ptrdiff_t>(cell_count), smooth.begin());
+            return;
+        }
+        const float* in = target.data();
+        float* out = smooth.data();
+        for (std::size_t i = 0; i < cell_count; ++i) {
+            out[i] += (in[i] - out[i]) * smoothing;
+        }
+    };
+    smooth_plane(cells.target_r, cells.smooth_r);
+    smooth_plane(cells.target_g, cells.smooth_g);
+    smooth_plane(cells.target_b, cells.smooth_b);
+    cells.primed = true;
 
-            if (ascii_mode && state.glyph != target_glyph) {
-                needs_update = true;
+    // Pass 3: quantise to 8-bit and mark changed cells.
+    for (int r = 0; r < grid_rows; ++r) {
+        const std::size_t row = static_cast<std::size_t>(r);
+        const std::size_t row_base = row * columns;
+        for (std::size_t column = 0; column < columns; ++column) {
+            const std::size_t cell_index = row_base + column;
+            const uint8_t red = static_cast<uint8_t>(clamp01(cells.smooth_r[cell_index]) * 255.0f + 0.5f);
+            const uint8_t green = static_cast<uint8_t>(clamp01(cells.smooth_g[cell_index]) * 255.0f + 0.5f);
+            const uint8_t blue = static_cast<uint8_t>(clamp01(cells.smooth_b[cell_index]) * 255.0f + 0.5f);
+
+            char glyph = ' ';
+            if (ascii_mode) {
+                const float luma = clamp01(cells.smooth_r[cell_index] * 0.299f + cells.smooth_g[cell_index] * 0.587f +
+                                           cells.smooth_b[cell_index] * 0.114f);
+                // sin(row_phase - 0.9c) and sin(row_phase + 0.35c) from the tables.
+                const float swirl =
+                    (frame.row_swirl_sin[row] * layout.swirl_cos[column] - frame.row_swirl_cos[row] * layout.swirl_sin[column] +
+                     1.0f) *
+                    0.5f;
+                const float texture = (frame.row_texture_sin[row] * layout.texture_cos[column] +
+                                       frame.row_texture_cos[row] * layout.texture_sin[column] + 1.0f) *
+                                      0.5f;
+                const float ascii_mix = clamp01(0.45f * cells.ascii_drive[cell_index] + 0.35f * luma + 0.2f * swirl);
+                const float ascii_value = clamp01(ascii_mix * 0.75f + texture * 0.25f + beat_strength * 0.2f);
+                const std::size_t glyph_count = kAsciiGlyphs.size();
+                const std::size_t glyph_idx = std::min<std::size_t>(
+                    glyph_count - 1, static_cast<std::size_t>(ascii_value * static_cast<float>(glyph_count - 1) + 0.5f));
+                glyph = kAsciiGlyphs[glyph_idx];
             }
 
+            const bool needs_update = seed || cells.color_r[cell_index] != red || cells.color_g[cell_index] != green ||
+                                      cells.color_b[cell_index] != blue || (ascii_mode && cells.glyph[cell_index] != glyph);
             if (!needs_update) {
                 continue;
             }
 
-            if (ascii_mode) {
-                const std::string ascii_fill(static_cast<std::size_t>(fill_w), target_glyph);
-                for (int dy = 0; dy < draw_height; ++dy) {
-                    const int y = offset_y + r * cell_h + dy;
-                    if (y >= static_cast<int>(plane_rows)) {
-                        continue;
-                    }
-                    const int x = offset_x + c * cell_w;
-                    if (x >= static_cast<int>(plane_cols)) {
-                        continue;
-                    }
-
-                    ncplane_set_bg_default(stdplane);
-                    ncplane_set_fg_rgb8(stdplane, color.r, color.g, color.b);
-                    ncplane_putstr_yx(stdplane, y, x, ascii_fill.c_str());
-                }
-            } else {
-                for (int dy = 0; dy < draw_height; ++dy) {
-                    const int y = offset_y + r * cell_h + dy;
-                    if (y >= static_cast<int>(plane_rows)) {
-                        continue;
-                    }
-                    const int x = offset_x + c * cell_w;
-                    if (x >= static_cast<int>(plane_cols)) {
-                        continue;
-                    }
-
-                    ncplane_set_bg_rgb8(stdplane, color.r, color.g, color.b);
-                    ncplane_putstr_yx(stdplane, y, x, cell_fill.c_str());
-                }
-            }
-
-            state.color = color;
-            state.glyph = target_glyph;
-            state.valid = true;
-        }
-    }
-
-    const int overlay_y = std::min(static_cast<int>(plane_rows) - 1, offset_y + grid_height);
-    const int overlay_x = offset_x;
-    auto clear_overlay_line = [&](int y) {
-        if (y >= static_cast<int>(plane_rows)) {
-            return;
+            cells.color_r[cell_index] = red;
+            cells.color_g[cell_index] = green;
+            cells.color_b[cell_index] = blue;
+            cells.glyph[cell_index] = glyph;
+            cache.row_dirty[column] = 1;
+            cache.grid_row_dirty[row] = 1;
         }
-        const int width = std::max(0, static_cast<int>(plane_cols) - overlay_x);
-        if (width <= 0) {
-            return;
+        if (sub_cell) {
+            std::fill(cache.row_dirty.begin(), cache.row_dirty.end(), 0);
+        } else {
+            flush_row(r);
         }
-        ncplane_set_fg_default(stdplane);
-        ncplane_set_bg_default(stdplane);
-        ncplane_printf_yx(stdplane, y, overlay_x, "%*s", width, "");
-    };
+    }
 
-    if (!show_overlay_metrics) {
-        clear_overlay_line(overlay_y);
-        clear_overlay_line(overlay_y + 1);
-        clear_overlay_line(overlay_y + 2);
-        return;
+    if (bitmap) {
+        blit_image(backend, cache, sub_pixels, term_top, term_left, term_bottom, term_right);
+    } else if (sub_cell) {
+        blit_sub_cells(backend, cache, sub_pixels, term_top, term_left, term_bottom, term_right);
     }
 
-    if (!show_metrics) {
-        clear_overlay_line(overlay_y);
-        clear_overlay_line(overlay_y + 1);
-        clear_overlay_line(overlay_y + 2);
+    const int overlay_y = std::min(static_cast<int>(plane_rows) - 1, term_bottom);
+    if (!overlay) {
+        for (TextLine& overlay_line : cache.overlay) {
+            clear_text(backend, overlay_line);
+        }
         return;
     }
+    // On small surfaces the overlay sits on the grid's last rows, where cell
+    // updates can overwrite it.
+    draw_overlay(backend, cache, view, active_blitter, input, overlay_y, term_left, term_bottom);
+}
 
-    clear_overlay_line(overlay_y);
-    ncplane_set_fg_rgb8(stdplane, 200, 200, 200);
-    ncplane_set_bg_default(stdplane);
-    ncplane_printf_yx(stdplane, overlay_y, overlay_x,
-                      "Audio %s | Mode: %s | Palette: %s | Grid: %dx%d | Sens: %.2f",
-                      metrics.active ? (file_stream ? "file" : "capturing") : "inactive",
-                      mode_name(mode),
-                      palette_name(palette),
-                      grid_rows,
-                      grid_cols,
-                      sensitivity);
-
-    if (overlay_y + 1 < static_cast<int>(plane_rows)) {
-        clear_overlay_line(overlay_y + 1);
-        ncplane_set_fg_rgb8(stdplane, 200, 200, 200);
-        ncplane_set_bg_default(stdplane);
-        ncplane_printf_yx(stdplane, overlay_y + 1, overlay_x,
-                          "RMS: %.3f | Peak: %.3f | Dropped: %zu | Beat: %.2f",
-                          metrics.rms,
-                          metrics.peak,
-                          metrics.dropped,
-                          beat_flash);
-    }
-
-    if (overlay_y + 2 < static_cast<int>(plane_rows)) {
-        clear_overlay_line(overlay_y + 2);
-        ncplane_set_fg_rgb8(stdplane, 200, 200, 200);
-        ncplane_set_bg_default(stdplane);
-        const std::string band_meter = format_band_meter(bands);
-        ncplane_printf_yx(stdplane, overlay_y + 2, overlay_x, "%s", band_meter.c_str());
+void Renderer::draw_metrics(const ViewSettings& view, const FrameInput& input) {
+    GridCache& cache = cache_->grid;
+    track_surface(cache, backend_.rows(), backend_.cols());
+    GridBlitter active_blitter = view.mode == VisualizationMode::Ascii ? GridBlitter::Solid : view.blitter;
+    if (active_blitter == GridBlitter::Pixel && backend_.cell_pixels().width <= 0) {
+        active_blitter = GridBlitter::Solid;
     }
+    draw_overlay(backend_, cache, view, active_blitter, input, 0, 0, 0);
 }
 
 } // namespace who
@@ -1,10 +1,11 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 
-#include <notcurses/notcurses.h>
-
 #include "audio_engine.h"
+#include "frame_pacer.h"
+#include "render_backend.h"
 
 namespace who {
 
@@ -24,22 +25,68 @@ enum class ColorPalette {
     DigitalViolet,
 };
 
-void draw_grid(notcurses* nc,
-               int grid_rows,
-               int grid_cols,
-               float time_s,
-               VisualizationMode mode,
-               ColorPalette palette,
-               float sensitivity,
-               const AudioMetrics& metrics,
-               const std::vector<float>& bands,
-               float beat_strength,
-               bool file_stream,
-               bool show_metrics,
-               bool show_overlay_metrics);
+// How grid cells map onto terminal cells. Solid paints each grid cell as a
+// block of background-coloured cells; the others pack 1x2, 2x2, 2x3 or 2x4
+// logical pixels into every terminal cell using block, sextant or braille
+// glyphs.
+enum class GridBlitter {
+    Solid,
+    HalfBlock,
+    Quadrant,
+    Sextant,
+    Braille,
+    // Bitmap graphics (sixel/kitty) where the terminal supports them.
+    Pixel,
+};
+
+// Everything the input loop can change about one grid.
+struct ViewSettings {
+    int grid_rows = 16;
+    int grid_cols = 16;
+    VisualizationMode mode = VisualizationMode::Bands;
+    ColorPalette palette = ColorPalette::Rainbow;
+    GridBlitter blitter = GridBlitter::Solid;
+    float sensitivity = 1.0f;
+};
+
+// Per-frame inputs shared by every renderer drawing that frame.
+struct FrameInput {
+    float time_s;
+    const AudioMetrics& metrics;
+    const std::vector<float>& bands;
+    float beat_strength;
+    bool file_stream;
+    const FrameStats& frame_stats;
+};
+
+// Draws the visualiser into one RenderBackend. Each instance keeps its own
+// cell state, layout tables and damage records, so renderers drawing to
+// separate surfaces can run concurrently.
+class Renderer {
+public:
+    explicit Renderer(RenderBackend& backend);
+    ~Renderer();
+
+    Renderer(const Renderer&) = delete;
+    Renderer& operator=(const Renderer&) = delete;
+
+    // The grid, centred on the surface, with the metrics overlay below it
+    // when `overlay` is set.
+    void draw(const ViewSettings& view, const FrameInput& input, bool overlay);
+    // Only the metrics overlay, from the surface's top-left corner, describing
+    // `view`.
+    void draw_metrics(const ViewSettings& view, const FrameInput& input);
+
+private:
+    struct Cache;
+
+    RenderBackend& backend_;
+    std::unique_ptr<Cache> cache_;
+};
 
 const char* mode_name(VisualizationMode mode);
 const char* palette_name(ColorPalette palette);
+const char* blitter_name(GridBlitter blitter);
 
 } // namespace who
 
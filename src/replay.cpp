@@ -0,0 +1,152 @@
+#include "replay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "notcurses_backend.h"
+
+namespace who {
+
+namespace {
+
+constexpr std::int64_t kSeekUs = 5'000'000;
+
+// One child plane per recorded surface, laid out as the panes were.
+class ReplayTarget final : public CaptureTarget {
+public:
+    explicit ReplayTarget(ncplane* parent) : parent_(parent) {}
+
+    ~ReplayTarget() override {
+        for (auto& [id, surface] : surfaces_) {
+            surface.backend.reset();
+            ncplane_destroy(surface.plane);
+        }
+    }
+
+    ReplayTarget(const ReplayTarget&) = delete;
+    ReplayTarget& operator=(const ReplayTarget&) = delete;
+
+    void place(std::uint32_t id, int y, int x, unsigned int rows, unsigned int cols) override {
+        Surface& surface = get(id);
+        if (rows == 0 || cols == 0) {
+            ncplane_resize_simple(surface.plane, 1, 1);
+            ncplane_move_yx(surface.plane, -1, -1);
+            return;
+        }
+        ncplane_resize_simple(surface.plane, rows, cols);
+        ncplane_move_yx(surface.plane, y, x);
+    }
+
+    RenderBackend& surface(std::uint32_t id) override { return *get(id).backend; }
+
+private:
+    struct Surface {
+        ncplane* plane = nullptr;
+        std::unique_ptr<NotcursesBackend> backend;
+    };
+
+    Surface& get(std::uint32_t id) {
+        Surface& surface = surfaces_[id];
+        if (!surface.plane) {
+            ncplane_options options{};
+            options.rows = 1;
+            options.cols = 1;
+            options.name = "replay";
+            surface.plane = ncplane_create(parent_, &options);
+            if (!surface.plane) {
+                surfaces_.erase(id);
+                throw std::runtime_error("Failed to create replay plane");
+            }
+            surface.backend = std::make_unique<NotcursesBackend>(surface.plane);
+        }
+        return surface;
+    }
+
+    ncplane* parent_;
+    std::unordered_map<std::uint32_t, Surface> surfaces_;
+};
+
+} // namespace
+
+void replay_capture(notcurses* nc, CaptureReader& reader) {
+    using Clock = std::chrono::steady_clock;
+    ReplayTarget target(notcurses_stdplane(nc));
+    const std::size_t frames = reader.frame_count();
+    const std::int64_t first_us = static_cast<std::int64_t>(reader.time_us(0));
+    const std::int64_t last_us = static_cast<std::int64_t>(reader.time_us(frames - 1));
+
+    // Playback position in capture time is `now - origin` while playing.
+    Clock::time_point origin = Clock::now() - std::chrono::microseconds(first_us);
+    std::int64_t paused_us = first_us;
+    bool paused = false;
+    std::size_t next = 0;
+
+    const auto position_us = [&]() {
+        if (paused) {
+            return paused_us;
+        }
+        return static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - origin).count());
+    };
+    // Rebuilds the screen from the nearest keyframe; frames in between are
+    // decoded but not rendered.
+    const auto seek = [&](std::int64_t time_us) {
+        time_us = std::clamp(time_us, first_us, last_us);
+        const std::size_t frame = reader.frame_at(static_cast<std::uint64_t>(time_us));
+        for (std::size_t i = reader.keyframe_before(frame); i <= frame; ++i) {
+            reader.apply(i, target);
+        }
+        next = frame + 1;
+        origin = Clock::now() - std::chrono::microseconds(time_us);
+        paused_us = time_us;
+        notcurses_render(nc);
+    };
+
+    while (true) {
+        const std::int64_t now_us = position_us();
+        bool dirty = false;
+        while (!paused && next < frames && static_cast<std::int64_t>(reader.time_us(next)) <= now_us) {
+            reader.apply(next++, target);
+            dirty = true;
+        }
+        if (dirty && notcurses_render(nc) != 0) {
+            throw std::runtime_error("Failed to render frame");
+        }
+
+        timespec timeout{};
+        const timespec* wait = nullptr;
+        if (!paused && next < frames) {
+            const std::int64_t until_us = std::max<std::int64_t>(0, static_cast<std::int64_t>(reader.time_us(next)) - now_us);
+            timeout.tv_sec = static_cast<time_t>(until_us / 1'000'000);
+            timeout.tv_nsec = static_cast<long>(until_us % 1'000'000) * 1000;
+            wait = &timeout;
+        }
+        ncinput input{};
+        const uint32_t key = notcurses_get(nc, wait, &input);
+        if (key == 0) {
+            continue;
+        }
+        if (key == static_cast<uint32_t>(-1) || key == 'q' || key == 'Q') {
+            return;
+        }
+        if (key == NCKEY_RESIZE) {
+            notcurses_render(nc);
+        } else if (key == ' ') {
+            if (paused) {
+                origin = Clock::now() - std::chrono::microseconds(paused_us);
+            } else {
+                paused_us = now_us;
+            }
+            paused = !paused;
+        } else if (key == NCKEY_LEFT) {
+            seek(now_us - kSeekUs);
+        } else if (key == NCKEY_RIGHT) {
+            seek(now_us + kSeekUs);
+        }
+    }
+}
+
+} // namespace who
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <notcurses/notcurses.h>
+
+#include "capture.h"
+
+namespace who {
+
+// Plays a capture back on the terminal at its original timing, with no audio
+// or analysis running. Space pauses, Left/Right seek by five seconds and q
+// quits; the last frame stays up until then. Throws std::runtime_error on a
+// corrupt frame.
+void replay_capture(notcurses* nc, CaptureReader& reader);
+
+} // namespace who
@@ -0,0 +1,313 @@
+#include "simd_kernels.h"
+
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#define WHO_KERNELS_SSE2 1
+#include <immintrin.h>
+#endif
+
+namespace who::kernels {
+
+namespace {
+
+void downmix_scalar(const float* interleaved, std::size_t frames, std::size_t channels, float* mono) {
+    for (std::size_t i = 0; i < frames; ++i) {
+        double sum = 0.0;
+        for (std::size_t ch = 0; ch < channels; ++ch) {
+            sum += interleaved[i * channels + ch];
+        }
+        mono[i] = static_cast<float>(sum / static_cast<double>(channels));
+    }
+}
+
+void downmix_s16_scalar(const std::int16_t* interleaved, std::size_t frames, std::size_t channels, float* mono) {
+    const double divisor = 32768.0 * static_cast<double>(channels);
+    for (std::size_t i = 0; i < frames; ++i) {
+        std::int32_t sum = 0;
+        for (std::size_t ch = 0; ch < channels; ++ch) {
+            sum += interleaved[i * channels + ch];
+        }
+        mono[i] = static_cast<float>(static_cast<double>(sum) / divisor);
+    }
+}
+
+void apply_window_scalar(const float* input, const float* window, float* output, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        output[i] = input[i] * window[i];
+    }
+}
+
+void spectrum_power_scalar(const float* spectrum, float norm, float* power, std::size_t bins) {
+    for (std::size_t k = 0; k < bins; ++k) {
+        const float real = spectrum[2 * k] * norm;
+        const float imag = spectrum[2 * k + 1] * norm;
+        power[k] = real * real + imag * imag;
+    }
+}
+
+void fill_u32_scalar(std::uint32_t* output, std::uint32_t value, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        output[i] = value;
+    }
+}
+
+#if defined(WHO_KERNELS_SSE2)
+
+// Mono input: (0.0 + x) / 1.0 only differs from x for -0.0, which becomes +0.0.
+void downmix_mono_sse2(const float* input, std::size_t frames, float* mono) {
+    const __m128 zero = _mm_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        _mm_storeu_ps(mono + i, _mm_add_ps(zero, _mm_loadu_ps(input + i)));
+    }
+    downmix_scalar(input + i, frames - i, 1, mono + i);
+}
+
+void downmix_sse2(const float* interleaved, std::size_t frames, std::size_t channels, float* mono) {
+    if (channels == 1) {
+        downmix_mono_sse2(interleaved, frames, mono);
+        return;
+    }
+    if (channels != 2) {
+        downmix_scalar(interleaved, frames, channels, mono);
+        return;
+    }
+
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d divisor = _mm_set1_pd(2.0);
+    std::size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        const __m128 a = _mm_loadu_ps(interleaved + 2 * i);
+        const __m128 b = _mm_loadu_ps(interleaved + 2 * i + 4);
+        const __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+
+        const __m128d left_lo = _mm_cvtps_pd(left);
+        const __m128d left_hi = _mm_cvtps_pd(_mm_movehl_ps(left, left));
+        const __m128d right_lo = _mm_cvtps_pd(right);
+        const __m128d right_hi = _mm_cvtps_pd(_mm_movehl_ps(right, right));
+
+        const __m128d sum_lo = _mm_div_pd(_mm_add_pd(_mm_add_pd(zero, left_lo), right_lo), divisor);
+        const __m128d sum_hi = _mm_div_pd(_mm_add_pd(_mm_add_pd(zero, left_hi), right_hi), divisor);
+        _mm_storeu_ps(mono + i, _mm_movelh_ps(_mm_cvtpd_ps(sum_lo), _mm_cvtpd_ps(sum_hi)));
+    }
+    downmix_scalar(interleaved + 2 * i, frames - i, 2, mono + i);
+}
+
+// For one or two channels the sum scaled by 2^-15 or 2^-16 is exact in float,
+// so the vector paths stay in single precision and still match the scalar
+// double division.
+void downmix_s16_sse2(const std::int16_t* interleaved, std::size_t frames, std::size_t channels, float* mono) {
+    if (channels != 1 && channels != 2) {
+        downmix_s16_scalar(interleaved, frames, channels, mono);
+        return;
+    }
+    std::size_t i = 0;
+    if (channels == 1) {
+        const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+        for (; i + 8 <= frames; i += 8) {
+            const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(interleaved + i));
+            // Sign-extend by placing each sample in the top half of a lane.
+            const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+            const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+            _mm_storeu_ps(mono + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(mono + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+    } else {
+        const __m128 scale = _mm_set1_ps(1.0f / 65536.0f);
+        const __m128i ones = _mm_set1_epi16(1);
+        for (; i + 4 <= frames; i += 4) {
+            const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(interleaved + 2 * i));
+            const __m128i sums = _mm_madd_epi16(samples, ones);
+            _mm_storeu_ps(mono + i, _mm_mul_ps(_mm_cvtepi32_ps(sums), scale));
+        }
+    }
+    downmix_s16_scalar(interleaved + channels * i, frames - i, channels, mono + i);
+}
+
+void apply_window_sse2(const float* input, const float* window, float* output, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(output + i, _mm_mul_ps(_mm_loadu_ps(input + i), _mm_loadu_ps(window + i)));
+    }
+    apply_window_scalar(input + i, window + i, output + i, count - i);
+}
+
+void spectrum_power_sse2(const float* spectrum, float norm, float* power, std::size_t bins) {
+    const __m128 scale = _mm_set1_ps(norm);
+    std::size_t k = 0;
+    for (; k + 4 <= bins; k += 4) {
+        const __m128 a = _mm_mul_ps(_mm_loadu_ps(spectrum + 2 * k), scale);
+        const __m128 b = _mm_mul_ps(_mm_loadu_ps(spectrum + 2 * k + 4), scale);
+        const __m128 a2 = _mm_mul_ps(a, a);
+        const __m128 b2 = _mm_mul_ps(b, b);
+        const __m128 re2 = _mm_shuffle_ps(a2, b2, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 im2 = _mm_shuffle_ps(a2, b2, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(power + k, _mm_add_ps(re2, im2));
+    }
+    spectrum_power_scalar(spectrum + 2 * k, norm, power + k, bins - k);
+}
+
+void fill_u32_sse2(std::uint32_t* output, std::uint32_t value, std::size_t count) {
+    const __m128i fill = _mm_set1_epi32(static_cast<int>(value));
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), fill);
+    }
+    fill_u32_scalar(output + i, value, count - i);
+}
+
+__attribute__((target("avx2"))) void downmix_avx2(const float* interleaved,
+                                                  std::size_t frames,
+                                                  std::size_t channels,
+                                                  float* mono) {
+    if (channels == 1) {
+        const __m256 zero = _mm256_setzero_ps();
+        std::size_t i = 0;
+        for (; i + 8 <= frames; i += 8) {
+            _mm256_storeu_ps(mono + i, _mm256_add_ps(zero, _mm256_loadu_ps(interleaved + i)));
+        }
+        downmix_scalar(interleaved + i, frames - i, 1, mono + i);
+        return;
+    }
+    if (channels != 2) {
+        downmix_scalar(interleaved, frames, channels, mono);
+        return;
+    }
+
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d divisor = _mm256_set1_pd(2.0);
+    std::size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        const __m128 a = _mm_loadu_ps(interleaved + 2 * i);
+        const __m128 b = _mm_loadu_ps(interleaved + 2 * i + 4);
+        const __m256d left = _mm256_cvtps_pd(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        const __m256d right = _mm256_cvtps_pd(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        const __m256d sum = _mm256_div_pd(_mm256_add_pd(_mm256_add_pd(zero, left), right), divisor);
+        _mm_storeu_ps(mono + i, _mm256_cvtpd_ps(sum));
+    }
+    downmix_scalar(interleaved + 2 * i, frames - i, 2, mono + i);
+}
+
+__attribute__((target("avx2"))) void downmix_s16_avx2(const std::int16_t* interleaved,
+                                                      std::size_t frames,
+                                                      std::size_t channels,
+                                                      float* mono) {
+    if (channels != 1 && channels != 2) {
+        downmix_s16_scalar(interleaved, frames, channels, mono);
+        return;
+    }
+    std::size_t i = 0;
+    if (channels == 1) {
+        const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+        for (; i + 8 <= frames; i += 8) {
+            const __m256i samples =
+                _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(interleaved + i)));
+            _mm256_storeu_ps(mono + i, _mm256_mul_ps(_mm256_cvtepi32_ps(samples), scale));
+        }
+    } else {
+        const __m256 scale = _mm256_set1_ps(1.0f / 65536.0f);
+        const __m256i ones = _mm256_set1_epi16(1);
+        for (; i + 8 <= frames; i += 8) {
+            const __m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(interleaved + 2 * i));
+            const __m256i sums = _mm256_madd_epi16(samples, ones);
+            _mm256_storeu_ps(mono + i, _mm256_mul_ps(_mm256_cvtepi32_ps(sums), scale));
+        }
+    }
+    downmix_s16_sse2(interleaved + channels * i, frames - i, channels, mono + i);
+}
+
+__attribute__((target("avx2"))) void apply_window_avx2(const float* input,
+                                                       const float* window,
+                                                       float* output,
+                                                       std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_loadu_ps(input + i), _mm256_loadu_ps(window + i)));
+    }
+    apply_window_scalar(input + i, window + i, output + i, count - i);
+}
+
+__attribute__((target("avx2"))) void spectrum_power_avx2(const float* spectrum,
+                                                         float norm,
+                                                         float* power,
+                                                         std::size_t bins) {
+    const __m256 scale = _mm256_set1_ps(norm);
+    std::size_t k = 0;
+    for (; k + 8 <= bins; k += 8) {
+        const __m256 a = _mm256_mul_ps(_mm256_loadu_ps(spectrum + 2 * k), scale);
+        const __m256 b = _mm256_mul_ps(_mm256_loadu_ps(spectrum + 2 * k + 8), scale);
+        const __m256 a2 = _mm256_mul_ps(a, a);
+        const __m256 b2 = _mm256_mul_ps(b, b);
+        // In-lane shuffles yield bins [0 1 4 5 | 2 3 6 7]; restore order with a
+        // cross-lane 64-bit permute.
+        const __m256 re2 = _mm256_shuffle_ps(a2, b2, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m256 im2 = _mm256_shuffle_ps(a2, b2, _MM_SHUFFLE(3, 1, 3, 1));
+        const __m256 sum = _mm256_add_ps(re2, im2);
+        const __m256d ordered = _mm256_permute4x64_pd(_mm256_castps_pd(sum), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_ps(power + k, _mm256_castpd_ps(ordered));
+    }
+    spectrum_power_sse2(spectrum + 2 * k, norm, power + k, bins - k);
+}
+
+__attribute__((target("avx2"))) void fill_u32_avx2(std::uint32_t* output, std::uint32_t value, std::size_t count) {
+    const __m256i fill = _mm256_set1_epi32(static_cast<int>(value));
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), fill);
+    }
+    fill_u32_sse2(output + i, value, count - i);
+}
+
+constexpr KernelTable kSse2Kernels{
+    "sse2", &downmix_sse2, &downmix_s16_sse2, &apply_window_sse2, &spectrum_power_sse2, &fill_u32_sse2};
+constexpr KernelTable kAvx2Kernels{
+    "avx2", &downmix_avx2, &downmix_s16_avx2, &apply_window_avx2, &spectrum_power_avx2, &fill_u32_avx2};
+
+bool cpu_has_avx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+#endif
+
+constexpr KernelTable kScalarKernels{"scalar",
+                                     &downmix_scalar,
+                                     &downmix_s16_scalar,
+                                     &apply_window_scalar,
+                                     &spectrum_power_scalar,
+                                     &fill_u32_scalar};
+
+const KernelTable& select_kernels() {
+#if defined(WHO_KERNELS_SSE2)
+    if (cpu_has_avx2()) {
+        return kAvx2Kernels;
+    }
+    return kSse2Kernels;
+#else
+    return kScalarKernels;
+#endif
+}
+
+} // namespace
+
+const KernelTable& scalar_kernels() {
+    return kScalarKernels;
+}
+
+const KernelTable& active_kernels() {
+    static const KernelTable& table = select_kernels();
+    return table;
+}
+
+std::vector<const KernelTable*> available_kernels() {
+    std::vector<const KernelTable*> tables{&kScalarKernels};
+#if defined(WHO_KERNELS_SSE2)
+    tables.push_back(&kSse2Kernels);
+    if (cpu_has_avx2()) {
+        tables.push_back(&kAvx2Kernels);
+    }
+#endif
+    return tables;
+}
+
+} // namespace who::kernels
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace who::kernels {
+
+// Hot-loop primitives shared by DspEngine, the file streamer and the pixel
+// rasteriser. Every variant produces results bit-identical to the scalar
+// reference implementation.
+struct KernelTable {
+    const char* name;
+    // mono[i] = (0.0 + sum of channels in double) / channels, rounded to float.
+    void (*downmix)(const float* interleaved, std::size_t frames, std::size_t channels, float* mono);
+    // mono[i] = (sum of 16-bit PCM channels) / (channels * 32768) in double,
+    // rounded to float: conversion to float and downmix in one pass.
+    void (*downmix_s16)(const std::int16_t* interleaved, std::size_t frames, std::size_t channels, float* mono);
+    // output[i] = input[i] * window[i].
+    void (*apply_window)(const float* input, const float* window, float* output, std::size_t count);
+    // power[k] = (re[k] * norm)^2 + (im[k] * norm)^2 for interleaved re/im bins.
+    void (*spectrum_power)(const float* spectrum, float norm, float* power, std::size_t bins);
+    // output[i] = value for `count` 32-bit pixels.
+    void (*fill_u32)(std::uint32_t* output, std::uint32_t value, std::size_t count);
+};
+
+const KernelTable& scalar_kernels();
+
+// Fastest table supported by the running CPU, picked once on first use.
+const KernelTable& active_kernels();
+
+// Every table usable on this CPU, scalar first; used by benchmarks.
+std::vector<const KernelTable*> available_kernels();
+
+inline void downmix(const float* interleaved, std::size_t frames, std::size_t channels, float* mono) {
+    active_kernels().downmix(interleaved, frames, channels, mono);
+}
+
+inline void downmix_s16(const std::int16_t* interleaved, std::size_t frames, std::size_t channels, float* mono) {
+    active_kernels().downmix_s16(interleaved, frames, channels, mono);
+}
+
+inline void apply_window(const float* input, const float* window, float* output, std::size_t count) {
+    active_kernels().apply_window(input, window, output, count);
+}
+
+inline void spectrum_power(const float* spectrum, float norm, float* power, std::size_t bins) {
+    active_kernels().spectrum_power(spectrum, norm, power, bins);
+}
+
+inline void fill_u32(std::uint32_t* output, std::uint32_t value, std::size_t count) {
+    active_kernels().fill_u32(output, value, count);
+}
+
+} // namespace who::kernels
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace who {
+
+// Fixed-length history of the most recent samples stored as a mirrored ring:
+// every sample is written twice, size() apart, so the latest size() samples are
+// always readable as one contiguous oldest-to-newest span without copying.
+class SlidingWindow {
+public:
+    explicit SlidingWindow(std::size_t size) : size_(size), storage_(size * 2, 0.0f), write_pos_(0) {}
+
+    void push(float sample) {
+        storage_[write_pos_] = sample;
+        storage_[write_pos_ + size_] = sample;
+        if (++write_pos_ == size_) {
+            write_pos_ = 0;
+        }
+    }
+
+    void push(const float* samples, std::size_t count) {
+        if (count >= size_) {
+            samples += count - size_;
+            count = size_;
+        }
+        while (count > 0) {
+            const std::size_t chunk = std::min(count, size_ - write_pos_);
+            std::memcpy(&storage_[write_pos_], samples, chunk * sizeof(float));
+            std::memcpy(&storage_[write_pos_ + size_], samples, chunk * sizeof(float));
+            write_pos_ = (write_pos_ + chunk == size_) ? 0 : write_pos_ + chunk;
+            samples += chunk;
+            count -= chunk;
+        }
+    }
+
+    // Oldest-to-newest view of the last size() samples.
+    const float* view() const { return storage_.data() + write_pos_; }
+    std::size_t size() const { return size_; }
+
+private:
+    std::size_t size_;
+    std::vector<float> storage_;
+    std::size_t write_pos_;
+};
+
+} // namespace who
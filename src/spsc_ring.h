@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace who {
+
+// Up to two contiguous pieces of ring memory; `second` is only non-empty when
+// the range wraps around the end of the buffer.
+template <typename T>
+struct RingSpan {
+    const T* first = nullptr;
+    std::size_t first_size = 0;
+    const T* second = nullptr;
+    std::size_t second_size = 0;
+
+    std::size_t size() const { return first_size + second_size; }
+};
+
+// Lock-free single-producer/single-consumer ring. The capacity is a power of
+// two so positions wrap with a mask, the two indices live on separate cache
+// lines, and each side keeps a private copy of the other side's index that it
+// only refreshes when the copy says the ring is full (or empty).
+template <typename T>
+class SpscRing {
+    static_assert(std::is_trivially_copyable_v<T>, "SpscRing copies elements with memcpy");
+
+public:
+    // The capacity is `min_capacity` rounded up to a power of two.
+    explicit SpscRing(std::size_t min_capacity) : buffer_(round_up(min_capacity)), mask_(buffer_.size() - 1) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    std::size_t capacity() const { return buffer_.size(); }
+
+    // Producer side: copies up to `count` elements in and returns how many fit,
+    // rounded down to a multiple of `granularity` (e.g. whole interleaved
+    // frames).
+    std::size_t write(const T* data, std::size_t count, std::size_t granularity = 1) {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        std::size_t free_space = capacity() - (head - cached_tail_);
+        if (free_space < count) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            free_space = capacity() - (head - cached_tail_);
+        }
+        const std::size_t to_write = std::min(count, free_space) / granularity * granularity;
+        if (to_write == 0) {
+            return 0;
+        }
+
+        const std::size_t offset = head & mask_;
+        const std::size_t first_chunk = std::min(to_write, capacity() - offset);
+        std::memcpy(buffer_.data() + offset, data, first_chunk * sizeof(T));
+        std::memcpy(buffer_.data(), data + first_chunk, (to_write - first_chunk) * sizeof(T));
+        head_.store(head + to_write, std::memory_order_release);
+        return to_write;
+    }
+
+    // Consumer side: exposes up to `max_count` readable elements in place.
+    // They stay valid, and are not overwritten, until commit_read().
+    RingSpan<T> reserve_read(std::size_t max_count) {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t available = cached_head_ - tail;
+        if (available < max_count) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            available = cached_head_ - tail;
+        }
+        const std::size_t to_read = std::min(max_count, available);
+        const std::size_t offset = tail & mask_;
+        const std::size_t first_chunk = std::min(to_read, capacity() - offset);
+        return RingSpan<T>{buffer_.data() + offset, first_chunk, buffer_.data(), to_read - first_chunk};
+    }
+
+    // Consumer side: releases the first `count` reserved elements to the
+    // producer.
+    void commit_read(std::size_t count) {
+        tail_.store(tail_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    // Consumer side: copies up to `count` elements out and returns how many
+    // were available.
+    std::size_t read(T* dest, std::size_t count) {
+        const RingSpan<T> span = reserve_read(count);
+        std::memcpy(dest, span.first, span.first_size * sizeof(T));
+        std::memcpy(dest + span.first_size, span.second, span.second_size * sizeof(T));
+        commit_read(span.size());
+        return span.size();
+    }
+
+private:
+    static std::size_t round_up(std::size_t value) {
+        std::size_t capacity = 1;
+        while (capacity < value) {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+    std::vector<T> buffer_;
+    const std::size_t mask_;
+    // Written by the producer.
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::size_t cached_tail_ = 0;
+    // Written by the consumer.
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    alignas(64) std::size_t cached_head_ = 0;
+};
+
+} // namespace who
@@ -0,0 +1,93 @@
+#include "thread_pool.h"
+
+namespace who {
+
+ThreadPool::ThreadPool(std::size_t workers) {
+    threads_.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+        threads_.emplace_back(&ThreadPool::run, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::parallel_for(std::size_t count, const std::function<void(std::size_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+    if (threads_.empty() || count == 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        count_ = count;
+        done_ = 0;
+        next_.store(0, std::memory_order_relaxed);
+        ++generation_;
+    }
+    start_.notify_all();
+
+    drain(task, count);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_.wait(lock, [this] { return done_ == count_ && active_ == 0; });
+    task_ = nullptr;
+}
+
+void ThreadPool::run() {
+    std::uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+        if (stop_) {
+            return;
+        }
+        seen = generation_;
+        if (task_ == nullptr) {
+            continue; // woke after that loop had already finished
+        }
+        const std::function<void(std::size_t)>& task = *task_;
+        const std::size_t count = count_;
+        ++active_;
+        lock.unlock();
+        drain(task, count);
+        lock.lock();
+        if (--active_ == 0 && done_ == count_) {
+            finished_.notify_one();
+        }
+    }
+}
+
+// Runs indices of the current loop until none are left, then credits them.
+void ThreadPool::drain(const std::function<void(std::size_t)>& task, std::size_t count) {
+    std::size_t ran = 0;
+    for (std::size_t i = next_.fetch_add(1, std::memory_order_relaxed); i < count;
+         i = next_.fetch_add(1, std::memory_order_relaxed)) {
+        task(i);
+        ++ran;
+    }
+    if (ran == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_ += ran;
+    if (done_ == count_ && active_ == 0) {
+        finished_.notify_one();
+    }
+}
+
+} // namespace who
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace who {
+
+// Fixed set of worker threads for fork/join loops. parallel_for() hands out
+// indices to the workers and the calling thread and returns once every index
+// has run; only one loop runs at a time.
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t workers);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t workers() const { return threads_.size(); }
+
+    void parallel_for(std::size_t count, const std::function<void(std::size_t)>& task);
+
+private:
+    void run();
+    void drain(const std::function<void(std::size_t)>& task, std::size_t count);
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable finished_;
+    bool stop_ = false;
+    std::uint64_t generation_ = 0;
+
+    const std::function<void(std::size_t)>* task_ = nullptr;
+    std::size_t count_ = 0;
+    std::atomic<std::size_t> next_{0};
+    std::size_t done_ = 0;
+    // Workers currently inside a loop; parallel_for waits for them to leave
+    // before the task can go out of scope.
+    std::size_t active_ = 0;
+};
+
+} // namespace who
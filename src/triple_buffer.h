@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace who {
+
+// Wait-free single-producer/single-consumer snapshot exchange. The writer fills
+// write_buffer() and calls publish(); the reader calls update() and then reads
+// read_buffer(). Neither side ever blocks or observes a partially written slot.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+    explicit TripleBuffer(const T& initial) {
+        for (Slot& slot : slots_) {
+            slot.value = initial;
+        }
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    T& write_buffer() { return slots_[back_].value; }
+
+    void publish() {
+        const std::uint32_t previous = middle_.exchange(back_ | kFreshBit, std::memory_order_acq_rel);
+        back_ = previous & kIndexMask;
+    }
+
+    // Returns true when a newer snapshot was swapped in since the last call.
+    bool update() {
+        if ((middle_.load(std::memory_order_relaxed) & kFreshBit) == 0) {
+            return false;
+        }
+        const std::uint32_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = previous & kIndexMask;
+        return true;
+    }
+
+    const T& read_buffer() const { return slots_[front_].value; }
+
+private:
+    static constexpr std::uint32_t kIndexMask = 0x3u;
+    static constexpr std::uint32_t kFreshBit = 0x4u;
+
+    struct alignas(64) Slot {
+        T value{};
+    };
+
+    std::array<Slot, 3> slots_{};
+    std::uint32_t back_ = 0;
+    alignas(64) std::atomic<std::uint32_t> middle_{1};
+    alignas(64) std::uint32_t front_ = 2;
+};
+
+} // namespace who
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace who {
+
+// Coalescing wakeup flag between threads. notify() only takes the mutex when
+// the flag goes from clear to set, so a producer signalling faster than the
+// consumer wakes pays one atomic exchange per call.
+class Wakeup {
+public:
+    Wakeup() = default;
+
+    Wakeup(const Wakeup&) = delete;
+    Wakeup& operator=(const Wakeup&) = delete;
+
+    void notify() {
+        if (pending_.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        condition_.notify_one();
+    }
+
+    // Clears the flag without blocking; returns whether it was set.
+    bool consume() { return pending_.exchange(false, std::memory_order_acq_rel); }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this] { return consume(); });
+    }
+
+    // Returns false if the timeout elapsed without a notification.
+    template <typename Rep, typename Period>
+    bool wait_for(const std::chrono::duration<Rep, Period>& timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return condition_.wait_for(lock, timeout, [this] { return consume(); });
+    }
+
+private:
+    std::atomic<bool> pending_{false};
+    std::mutex mutex_;
+    std::condition_variable condition_;
+};
+
+} // namespace who